@@ -1,64 +1,38 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
-#define PACKET_LENGTH 6
 
-// Indexes
-#define SYNC_INDEX      0
-#define CID_INDEX       1
-#define STATUS_INDEX    2
-#define VOLT_H_INDEX    3
-#define VOLT_L_INDEX    4
-#define CHECKSUM_INDEX  5
-
-// Bit Masks for Battery Status
-#define DISCHARGE_MASK      (1 << 0)
-#define BATTERY_SUPPORTED   (1 << 5)
-#define VOLTAGE_OK_MASK     (1 << 6)
-#define BATTERY_ERROR_MASK  (1 << 7)
+// Frame length, indexes and status bit masks come from the shared schema
+#include "comchip.h"
+#include "comchip_frame.h"
 
 // Sample packet 
 
 //Packet definition
     // SYNC | CID  | Status | Volt_H | Volt_L  | Checksum
-    // 0x55 | 0x81 | 0x00   | 0x96   | 0xFE    | 0x3F
-
-
-uint8_t packet[PACKET_LENGTH] = {0x55, 0x81, 0x00, 0x96, 0xFE, 0x3F};
+    // 0x55 | 0x81 | 0x00   | 0x96   | 0xFE    | 0xE8 (computed at compile time)
 
+_Static_assert(COMCHIP_CHECKSUM(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE) == 0xE8, "sample packet checksum");
+uint8_t packet[COMCHIP_STATUS_FRAME_LEN] = COMCHIP_FRAME(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE);
 
 
-// Checksum
-uint8_t calculate_checksum(uint8_t cid, const uint8_t* data_buffer, uint8_t len) {
-    uint16_t tmp = cid;
-    uint8_t i;
-
-    for (i = 0; i < len; i++) {
-        tmp += data_buffer[i];
-        
-        if (tmp >= 256u) {
-            tmp -= 255u; // This is an unusual overflow handling as per document
-        }
-    }
-    tmp = (~tmp) & 0x00FFu; // Bitwise NOT and mask to 8 bits
-    return (uint8_t)tmp;
-}
 
+// Checksum: calculate_checksum() from comchip.h
 
 // Decode battery status bits
 void decode_battery_status(uint8_t status) {
    printf("Battery Status:\n");
-   if (!(status & DISCHARGE_MASK))
+   if (!(status & STATUS_BIT_NOT_DISCHARGEABLE))
        printf(" Battery can be discharged\n");
-   if (!(status & BATTERY_SUPPORTED))
+   if (!(status & STATUS_BIT_NOT_SUPPORTED))
        printf(" Battery is supported\n");
    else
        printf(" Battery NOT supported\n");
-   if (!(status & VOLTAGE_OK_MASK))
+   if (!(status & STATUS_BIT_UNDER_VOLTAGE))
        printf(" Battery voltage is OK\n");
    else
        printf(" Battery voltage NOT OK\n");
-   if (!(status & BATTERY_ERROR_MASK))
+   if (!(status & STATUS_BIT_BATTERY_ERROR))
        printf(" Battery has NO error\n");
    else
        printf(" Battery has error\n");
@@ -67,8 +41,8 @@ void decode_battery_status(uint8_t status) {
 
 int main() {
    // Step 1: Check checksum
-   uint8_t calculated = calculate_checksum(  packet[1],  &packet[2], PACKET_LENGTH - 3 );
-   uint8_t received = packet[CHECKSUM_INDEX];   
+   uint8_t calculated = calculate_checksum(  packet[COMCHIP_CID_INDEX],  &packet[COMCHIP_DATA_INDEX], COMCHIP_STATUS_FRAME_LEN - COMCHIP_ENVELOPE_LEN );
+   uint8_t received = packet[COMCHIP_STATUS_FRAME_LEN - 1];   
    if (calculated != received) {
        printf("Checksum mismatch! Calculated: 0x%X, Received: 0x%X\n", calculated, received);
        return -1;
@@ -78,16 +52,16 @@ int main() {
   
   
    // Step 2: Decode battery status  
-   uint8_t status = packet[STATUS_INDEX];
+   uint8_t status = (uint8_t)comchip_status_resp_status_byte(packet);
    decode_battery_status(status);
    
 
 
    // Step 3: Only print voltage if supported and no error
-   bool supported = !(status & BATTERY_SUPPORTED);
-   bool error = status & BATTERY_ERROR_MASK;
+   bool supported = !(status & STATUS_BIT_NOT_SUPPORTED);
+   bool error = status & STATUS_BIT_BATTERY_ERROR;
    if (supported && !error) {
-       uint16_t voltage_raw = ((uint16_t)packet[VOLT_H_INDEX] << 8) | packet[VOLT_L_INDEX];
+       uint16_t voltage_raw = (uint16_t)comchip_status_resp_voltage_mV(packet);
        printf("Battery Voltage: %u V\n", voltage_raw/1000);
    } else {
        printf("Battery not supported or has error. Voltage not displayed.\n");
@@ -0,0 +1,55 @@
+// Batch decode of a burst of status frames into columns, then column-wise aggregation
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "comchip_batch.h"
+
+#define BURST_FRAMES 10000u
+
+int main() {
+    static uint8_t frames[BURST_FRAMES * COMCHIP_STATUS_FRAME_LEN];
+    static uint16_t voltage[BURST_FRAMES];
+    static uint64_t error[COMCHIP_BITMAP_WORDS(BURST_FRAMES)];
+    static uint64_t under[COMCHIP_BITMAP_WORDS(BURST_FRAMES)];
+    static uint64_t unsupported[COMCHIP_BITMAP_WORDS(BURST_FRAMES)];
+    static uint64_t valid[COMCHIP_BITMAP_WORDS(BURST_FRAMES)];
+
+    // Build a burst: voltages around 38 V, some under voltage, every 100th frame corrupted
+    srand(11);
+    for (size_t i = 0; i < BURST_FRAMES; i++) {
+        uint8_t* f = &frames[i * COMCHIP_STATUS_FRAME_LEN];
+        uint16_t mv = (uint16_t)(37000 + rand() % 3000);
+        f[0] = COMCHIP_SYNC_BYTE;
+        f[1] = COMCHIP_CID_GET_STATUS_RESP;
+        f[2] = (rand() % 20 == 0) ? STATUS_BIT_UNDER_VOLTAGE : 0x00;
+        f[3] = (uint8_t)(mv >> 8);
+        f[4] = (uint8_t)(mv & 0xFF);
+        f[5] = calculate_checksum(f[1], &f[2], COMCHIP_STATUS_FRAME_LEN - 3);
+        if (i % 100 == 0) {
+            f[5] ^= 0xFF;
+        }
+    }
+
+    BatteryStatusColumns columns = { voltage, error, under, unsupported, valid };
+    size_t n_valid = comchip_decode_batch(frames, BURST_FRAMES, &columns);
+
+    // Aggregate column by column: invalid frames already read as voltage 0 / no flags
+    uint64_t voltage_sum = 0;
+    for (size_t i = 0; i < BURST_FRAMES; i++) {
+        voltage_sum += voltage[i];
+    }
+    size_t n_under = 0, n_error = 0;
+    for (size_t w = 0; w < COMCHIP_BITMAP_WORDS(BURST_FRAMES); w++) {
+        n_under += (size_t)__builtin_popcountll(under[w]);
+        n_error += (size_t)__builtin_popcountll(error[w]);
+    }
+
+    printf("Valid frames: %zu of %u\n", n_valid, BURST_FRAMES);
+    printf("Mean Battery Voltage: %llu mV\n", n_valid ? (unsigned long long)(voltage_sum / n_valid) : 0ull);
+    printf("Under Voltage frames: %zu\n", n_under);
+    printf("Battery Error frames: %zu\n", n_error);
+    return 0;
+}
@@ -0,0 +1,171 @@
+// Two simulated RS-485 buses with six COMChips each. Every bus is one
+// pseudo-terminal pair: the arbiter writes addressed requests into the slave
+// end, and a simulator on the master end plays all drops of that bus,
+// answering the addressed one after a turnaround delay. Drop 0x15 on bus 1
+// never answers.
+// The run is made once with backoff for missed drops and once without, where
+// the dead drop costs a full timeout on every turn.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "comchip_bus.h"
+#include "comchip_ingest.h"
+
+#define EXAMPLE_BUSES      2
+#define EXAMPLE_DROPS      6
+#define EXAMPLE_BAUD       115200
+#define EXAMPLE_RUN_NS     (1 * COMCHIP_NS_PER_S)
+#define EXAMPLE_TURNAROUND (1 * COMCHIP_NS_PER_MS) // Request to response on the wire
+#define EXAMPLE_DEAD_ADDR  0x15
+
+static uint8_t drop_addr(int bus, int drop) {
+    return (uint8_t)(0x10 * (bus + 1) + drop);
+}
+
+// --- Bus Simulator (master ends) ---
+typedef struct {
+    int      fd;
+    int      index;
+    uint8_t  partial[COMCHIP_BUS_REQ_LEN];
+    uint8_t  partial_len;
+    uint64_t due;         // Response time of the request being answered (0 = none)
+    uint16_t mV;          // Voltage the answering drop reports
+} SimBus;
+
+static void sim_receive(SimBus* b, uint64_t now) {
+    uint8_t buf[64];
+    ssize_t n;
+    while ((n = read(b->fd, buf, sizeof(buf))) > 0) {
+        for (ssize_t i = 0; i < n; i++) {
+            b->partial[b->partial_len++] = buf[i];
+            if (b->partial_len < COMCHIP_BUS_REQ_LEN) {
+                continue;
+            }
+            b->partial_len = 0;
+            uint8_t addr = b->partial[0];
+            if (comchip_status_req_validate(b->partial + 1, COMCHIP_STATUS_REQ_FRAME_LEN).error != COMCHIP_OK ||
+                addr == EXAMPLE_DEAD_ADDR || (addr & 0xF0) != 0x10 * (b->index + 1)) {
+                continue; // Not for any drop on this bus, or the drop is dead
+            }
+            b->due = now + EXAMPLE_TURNAROUND;
+            b->mV = (uint16_t)(38000 + addr);
+        }
+    }
+}
+
+static uint64_t sim_respond(SimBus* b, uint64_t now) {
+    if (b->due && b->due <= now) {
+        uint8_t payload[3] = { 0x00, (uint8_t)(b->mV >> 8), (uint8_t)b->mV };
+        uint8_t resp[COMCHIP_STATUS_FRAME_LEN];
+        comchip_encode_frames(resp, sizeof(resp), COMCHIP_CID_GET_STATUS_RESP, payload, sizeof(payload), 1);
+        if (write(b->fd, resp, sizeof(resp)) == (ssize_t)sizeof(resp)) {
+            b->due = 0;
+        }
+    }
+    return b->due ? b->due : UINT64_MAX;
+}
+
+// --- Arbiter Side ---
+static uint64_t wrong_voltage;
+
+static void on_response(void* ctx, uint32_t bus, uint8_t addr, const BatteryStatusData* data, uint64_t rtt_ns) {
+    (void)ctx;
+    (void)bus;
+    (void)rtt_ns;
+    if (data->battery_voltage_mV != 38000 + addr) {
+        wrong_voltage++; // Response attributed to the wrong drop
+    }
+}
+
+static int run(bool backoff) {
+    static ComchipIngest ingest;
+    static ComchipBusArbiter arbiter;
+    SimBus sims[EXAMPLE_BUSES];
+
+    if (comchip_bus_init(&arbiter, EXAMPLE_BUSES, on_response, NULL, NULL) < 0 ||
+        comchip_ingest_init(&ingest, COMCHIP_INGEST_AUTO, EXAMPLE_BUSES, comchip_bus_on_batch, NULL, &arbiter) < 0) {
+        perror("setup");
+        return -1;
+    }
+    if (!backoff) {
+        arbiter.backoff_ns = 0;
+    }
+    for (int i = 0; i < EXAMPLE_BUSES; i++) {
+        int slave;
+        memset(&sims[i], 0, sizeof(sims[i]));
+        sims[i].index = i;
+        if (comchip_pty_open(&sims[i].fd, &slave, COMCHIP_SERIAL_VMIN) < 0) {
+            perror("comchip_pty_open");
+            return -1;
+        }
+        fcntl(sims[i].fd, F_SETFL, fcntl(sims[i].fd, F_GETFL) | O_NONBLOCK);
+        int32_t bus = comchip_ingest_add(&ingest, slave, COMCHIP_STATUS_FRAME_LEN);
+        comchip_bus_attach(&arbiter, (uint32_t)bus, slave, EXAMPLE_BAUD);
+        for (int k = 0; k < EXAMPLE_DROPS; k++) {
+            comchip_bus_add_drop(&arbiter, (uint32_t)bus, drop_addr(i, k));
+        }
+        for (int k = 0; k < EXAMPLE_DROPS; k++) {
+            comchip_bus_poll(&arbiter, (uint32_t)bus, drop_addr(i, k), COMCHIP_POLL_CONTINUOUS);
+        }
+    }
+
+    uint64_t start = comchip_now_ns();
+    uint64_t now = start;
+    while (now - start < EXAMPLE_RUN_NS) {
+        int timeout = comchip_bus_tick(&arbiter);
+
+        now = comchip_now_ns();
+        uint64_t sim_next = UINT64_MAX;
+        for (int i = 0; i < EXAMPLE_BUSES; i++) {
+            sim_receive(&sims[i], now);
+            uint64_t due = sim_respond(&sims[i], now);
+            sim_next = due < sim_next ? due : sim_next;
+        }
+        int sim_timeout = comchip_timeout_ms(sim_next, now);
+        if (sim_timeout >= 0 && (timeout < 0 || sim_timeout < timeout)) {
+            timeout = sim_timeout;
+        }
+        comchip_ingest_run_once(&ingest, timeout > 1 ? 1 : timeout); // The simulator shares this thread
+        now = comchip_now_ns();
+    }
+
+    printf("%s backoff for missed drops:\n", backoff ? "With" : "Without");
+    printf("Bus | Addr | Polls | Resp | Timeouts | Failures | RTT avg (ms)\n");
+    for (int i = 0; i < EXAMPLE_BUSES; i++) {
+        const ComchipBus* b = &arbiter.buses[i];
+        for (int k = 0; k < b->drop_count; k++) {
+            const ComchipDrop* d = &b->drops[k];
+            printf("%3d | 0x%02X | %5llu | %4llu | %8llu | %8llu | %5.2f\n", i, d->addr,
+                   (unsigned long long)d->polls, (unsigned long long)d->responses,
+                   (unsigned long long)d->timeouts, (unsigned long long)d->failures,
+                   d->responses ? (double)d->rtt_sum_ns / d->responses / 1e6 : 0.0);
+        }
+    }
+    printf("Bus | Transactions | Busy  | Timeouts | Gaps (ms) | Wire  | Unmatched\n");
+    for (int i = 0; i < EXAMPLE_BUSES; i++) {
+        const ComchipBus* b = &arbiter.buses[i];
+        double elapsed = (double)(now - b->since_ns);
+        printf("%3d | %12llu | %4.1f%% | %7.1f%% | %9.2f | %4.1f%% | %9llu\n", i,
+               (unsigned long long)b->transactions, 100.0 * b->busy_ns / elapsed, 100.0 * b->timeout_ns / elapsed,
+               b->gap_ns / 1e6, 100.0 * comchip_bus_wire_utilization(b, now), (unsigned long long)b->unmatched);
+    }
+    printf("\n");
+
+    comchip_ingest_close(&ingest);
+    comchip_bus_free(&arbiter);
+    for (int i = 0; i < EXAMPLE_BUSES; i++) {
+        close(sims[i].fd);
+    }
+    return 0;
+}
+
+int main() {
+    if (run(true) < 0 || run(false) < 0) {
+        return 1;
+    }
+    printf("Responses taken for the wrong drop: %llu\n", (unsigned long long)wrong_voltage);
+    return 0;
+}
@@ -0,0 +1,148 @@
+// Many readers asking for the status of a few simulated batteries. Every
+// battery sits behind a pseudo-terminal pair and answers after a link delay.
+// Twenty readers each want one random battery's status every millisecond or
+// so; the cache answers within its TTL from memory and collapses concurrent
+// misses into one poll. The run is repeated with a TTL of 0, which still
+// coalesces but never hits.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "comchip_cache.h"
+#include "comchip_ingest.h"
+
+#define EXAMPLE_DEVICES    4
+#define EXAMPLE_READERS    20
+#define EXAMPLE_RUN_NS     (500 * COMCHIP_NS_PER_MS)
+#define EXAMPLE_LINK_DELAY (2 * COMCHIP_NS_PER_MS)
+#define EXAMPLE_TTL        (20 * COMCHIP_NS_PER_MS)
+
+// --- Battery Simulator (master ends) ---
+typedef struct {
+    int      fd;
+    uint64_t due; // Response time of the request being answered (0 = none)
+    uint64_t requests;
+} SimBattery;
+
+static void sim_receive(SimBattery* b, uint64_t now) {
+    uint8_t buf[64];
+    ssize_t n;
+    while ((n = read(b->fd, buf, sizeof(buf))) > 0) {
+        b->requests += (uint64_t)n / COMCHIP_STATUS_REQ_FRAME_LEN;
+        b->due = now + EXAMPLE_LINK_DELAY; // The engine sends one at a time (window 1)
+    }
+}
+
+static uint64_t sim_respond(SimBattery* b, uint64_t now) {
+    static const uint8_t response[] = COMCHIP_FRAME(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE);
+    if (b->due && b->due <= now && write(b->fd, response, sizeof(response)) == (ssize_t)sizeof(response)) {
+        b->due = 0;
+    }
+    return b->due ? b->due : UINT64_MAX;
+}
+
+// --- Readers ---
+typedef struct {
+    ComchipCacheRead read;
+    bool             waiting;
+    uint64_t         next_ns;
+    uint64_t         answers;
+} Reader;
+
+static void on_read(void* ctx, uint32_t dev, const BatteryStatusData* data) {
+    Reader* r = (Reader*)ctx;
+    (void)dev;
+    r->waiting = false;
+    r->answers += data != NULL;
+}
+
+static int run(uint64_t ttl_ns) {
+    static ComchipIngest ingest;
+    static ComchipEngine engine;
+    static ComchipStatusCache cache;
+    SimBattery sims[EXAMPLE_DEVICES];
+    Reader readers[EXAMPLE_READERS];
+
+    if (comchip_engine_init(&engine, EXAMPLE_DEVICES, comchip_cache_on_response, comchip_cache_on_failure,
+                            &cache) < 0 ||
+        comchip_cache_init(&cache, &engine, ttl_ns, NULL, NULL, NULL) < 0 ||
+        comchip_ingest_init(&ingest, COMCHIP_INGEST_AUTO, EXAMPLE_DEVICES, comchip_engine_on_batch, NULL, &engine) < 0) {
+        perror("setup");
+        return -1;
+    }
+    for (int i = 0; i < EXAMPLE_DEVICES; i++) {
+        int slave;
+        memset(&sims[i], 0, sizeof(sims[i]));
+        if (comchip_pty_open(&sims[i].fd, &slave, COMCHIP_SERIAL_VMIN) < 0) {
+            perror("comchip_pty_open");
+            return -1;
+        }
+        fcntl(sims[i].fd, F_SETFL, fcntl(sims[i].fd, F_GETFL) | O_NONBLOCK);
+        int32_t dev = comchip_ingest_add(&ingest, slave, COMCHIP_STATUS_FRAME_LEN);
+        comchip_engine_attach(&engine, (uint32_t)dev, slave, 1);
+    }
+    memset(readers, 0, sizeof(readers));
+    for (int i = 0; i < EXAMPLE_READERS; i++) {
+        readers[i].read.fn = on_read;
+        readers[i].read.ctx = &readers[i];
+    }
+
+    srand(1);
+    uint64_t start = comchip_now_ns();
+    uint64_t now = start;
+    uint64_t gets = 0;
+    while (now - start < EXAMPLE_RUN_NS) {
+        comchip_engine_tick(&engine);
+
+        now = comchip_now_ns();
+        for (int i = 0; i < EXAMPLE_READERS; i++) {
+            Reader* r = &readers[i];
+            if (r->waiting || now < r->next_ns) {
+                continue;
+            }
+            r->next_ns = now + COMCHIP_NS_PER_MS / 2 + (uint64_t)(rand() % 1000) * 1000; // 0.5-1.5 ms
+            gets++;
+            if (comchip_cache_get(&cache, (uint32_t)(rand() % EXAMPLE_DEVICES), &r->read)) {
+                r->answers++;
+            } else {
+                r->waiting = true;
+            }
+        }
+        for (int i = 0; i < EXAMPLE_DEVICES; i++) {
+            sim_receive(&sims[i], now);
+            sim_respond(&sims[i], now);
+        }
+        comchip_ingest_run_once(&ingest, 0); // Readers and simulator share this thread: poll, don't wait
+        now = comchip_now_ns();
+    }
+
+    uint64_t requests = 0, answers = 0;
+    for (int i = 0; i < EXAMPLE_DEVICES; i++) {
+        requests += sims[i].requests;
+    }
+    for (int i = 0; i < EXAMPLE_READERS; i++) {
+        answers += readers[i].answers;
+    }
+    printf("TTL %llu ms: %llu reads, %llu answered; %llu hits, %llu coalesced, %llu polls; %llu bus requests\n",
+           (unsigned long long)(ttl_ns / COMCHIP_NS_PER_MS), (unsigned long long)gets, (unsigned long long)answers,
+           (unsigned long long)cache.hits, (unsigned long long)cache.coalesced, (unsigned long long)cache.polls,
+           (unsigned long long)requests);
+
+    comchip_ingest_close(&ingest);
+    comchip_cache_free(&cache);
+    comchip_engine_free(&engine);
+    for (int i = 0; i < EXAMPLE_DEVICES; i++) {
+        close(sims[i].fd);
+    }
+    return 0;
+}
+
+int main() {
+    if (run(EXAMPLE_TTL) < 0 || run(0) < 0) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,162 @@
+// Record simulated link traffic from four ports into a capture file, map it
+// back and decode it. Port 2 runs newer firmware (7-byte frames); every
+// read() is recorded as one chunk of 1 to 8 frames, sometimes split
+// mid-frame as a real read() would. The file is then walked twice: once
+// touching every byte only, once through a stream decoder per port.
+// A copy cut short in the middle (as after a crash) still reads up to the
+// cut.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "comchip_capture.h"
+#include "comchip_frame.h"
+#include "comchip_stream.h"
+#include "comchip_time.h"
+
+#define EXAMPLE_PORTS  4
+#define EXAMPLE_CHUNKS 2000000
+
+static const uint8_t frames6[][COMCHIP_STATUS_FRAME_LEN] = {
+    COMCHIP_FRAME(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE),
+    COMCHIP_FRAME(COMCHIP_CID_GET_STATUS_RESP, 0x40, 0x96, 0xFE), // Under voltage
+};
+static const uint8_t frames7[][COMCHIP_STATUS_RESP7_FRAME_LEN] = {
+    COMCHIP_FRAME(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE, 0x01),
+    COMCHIP_FRAME(COMCHIP_CID_GET_STATUS_RESP, 0x80, 0x96, 0xFE, 0x01), // Battery error
+};
+
+static void count_frame(void* ctx, const BatteryStatusData* data) {
+    (void)data;
+    (*(uint64_t*)ctx)++;
+}
+
+static int write_capture(const char* path, uint64_t* raw_bytes) {
+    ComchipCaptureWriter w;
+    uint64_t t = comchip_now_ns();
+    if (comchip_capture_create(&w, path, t) < 0) {
+        return -1;
+    }
+
+    // Per-port byte stream, cut into reads
+    uint8_t stream[EXAMPLE_PORTS][64 * COMCHIP_STATUS_RESP7_FRAME_LEN];
+    size_t held[EXAMPLE_PORTS] = {0};
+    srand(1);
+    uint64_t start = comchip_now_ns();
+    for (uint32_t c = 0; c < EXAMPLE_CHUNKS; c++) {
+        uint16_t port = (uint16_t)(rand() % EXAMPLE_PORTS);
+        int n = 1 + rand() % 8;
+        for (int k = 0; k < n; k++) {
+            int which = rand() % 16 == 0;
+            if (port == 2) {
+                memcpy(stream[port] + held[port], frames7[which], COMCHIP_STATUS_RESP7_FRAME_LEN);
+                held[port] += COMCHIP_STATUS_RESP7_FRAME_LEN;
+            } else {
+                memcpy(stream[port] + held[port], frames6[which], COMCHIP_STATUS_FRAME_LEN);
+                held[port] += COMCHIP_STATUS_FRAME_LEN;
+            }
+        }
+        size_t len = held[port] - (size_t)(rand() % 3); // Sometimes a frame's tail waits for the next read
+        t += 1000 + (uint64_t)(rand() % 100000);
+        if (comchip_capture_append(&w, port, t, stream[port], (uint32_t)len) < 0) {
+            return -1;
+        }
+        *raw_bytes += len;
+        memmove(stream[port], stream[port] + len, held[port] - len);
+        held[port] -= len;
+    }
+    uint64_t writes = w.writes;
+    if (comchip_capture_close(&w) < 0) {
+        return -1;
+    }
+    double secs = (comchip_now_ns() - start) / 1e9;
+    printf("Wrote %u chunks, %.1f MB raw, in %.3f s (%.0f MB/s), %llu write() calls before close\n",
+           EXAMPLE_CHUNKS, *raw_bytes / 1e6, secs, *raw_bytes / 1e6 / secs, (unsigned long long)writes);
+    return 0;
+}
+
+static int read_capture(const char* path) {
+    ComchipCaptureReader r;
+    if (comchip_capture_map(&r, path) < 0) {
+        return -1;
+    }
+    printf("%s: %zu bytes, %s, %llu chunks indexed\n", path, r.len, r.index ? "complete" : "no trailer",
+           (unsigned long long)r.chunk_count);
+
+    // Touch every byte
+    uint64_t start = comchip_now_ns();
+    uint64_t sum = 0, bytes = 0, chunks = 0;
+    ComchipCaptureChunk c;
+    for (size_t off = comchip_capture_begin(&r); comchip_capture_next(&r, &off, &c);) {
+        for (uint32_t i = 0; i < c.len; i++) {
+            sum += c.data[i];
+        }
+        bytes += c.len;
+        chunks++;
+    }
+    double secs = (comchip_now_ns() - start) / 1e9;
+    printf("  Walk:   %llu chunks, %.1f MB in %.3f s (%.2f GB/s, sum %llu)\n", (unsigned long long)chunks,
+           bytes / 1e6, secs, bytes / 1e9 / secs, (unsigned long long)sum);
+
+    // Decode zero-copy, one stream decoder per port
+    ComchipStream decoders[EXAMPLE_PORTS];
+    uint64_t frames[EXAMPLE_PORTS] = {0};
+    for (int p = 0; p < EXAMPLE_PORTS; p++) {
+        comchip_stream_init(&decoders[p], count_frame, &frames[p]);
+    }
+    start = comchip_now_ns();
+    for (size_t off = comchip_capture_begin(&r); comchip_capture_next(&r, &off, &c);) {
+        comchip_stream_feed(&decoders[c.port], c.data, c.len);
+    }
+    secs = (comchip_now_ns() - start) / 1e9;
+    uint64_t total = 0;
+    for (int p = 0; p < EXAMPLE_PORTS; p++) {
+        total += frames[p];
+    }
+    printf("  Decode: %llu frames in %.3f s (%.2f GB/s); port 2 layout %u bytes\n", (unsigned long long)total, secs,
+           bytes / 1e9 / secs, decoders[2].layout_len);
+
+    if (r.index) {
+        uint64_t mid = (r.header->start_ns + ((const ComchipCaptureTrailer*)(r.base + r.len - 32))->end_ns) / 2;
+        uint64_t i = comchip_capture_seek(&r, mid);
+        if (comchip_capture_chunk_at(&r, i, &c)) {
+                printf("  Seek to the middle of the capture: chunk %llu, port %u, +%.3f s\n", (unsigned long long)i,
+                   c.port, (c.timestamp_ns - r.header->start_ns) / 1e9);
+        }
+    }
+    comchip_capture_unmap(&r);
+    return 0;
+}
+
+int main() {
+    const char* path = "/tmp/comchip-example.cap";
+    const char* cut = "/tmp/comchip-example-cut.cap";
+    uint64_t raw = 0;
+    if (write_capture(path, &raw) < 0 || read_capture(path) < 0) {
+        perror("capture");
+        return 1;
+    }
+
+    // Copy the first half, as if the writer had died there
+    ComchipCaptureReader r;
+    if (comchip_capture_map(&r, path) < 0) {
+        perror("capture");
+        return 1;
+    }
+    int fd = open(cut, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || write(fd, r.base, r.len / 2) != (ssize_t)(r.len / 2)) {
+        perror(cut);
+        return 1;
+    }
+    close(fd);
+    comchip_capture_unmap(&r);
+    if (read_capture(cut) < 0) {
+        perror("capture");
+        return 1;
+    }
+    unlink(path);
+    unlink(cut);
+    return 0;
+}
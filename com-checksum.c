@@ -0,0 +1,77 @@
+// Cross-check every checksum kernel against calculate_checksum() and time batch verification
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "comchip_checksum.h"
+
+#define BATCH_FRAMES (1u << 20)
+
+int main() {
+    uint8_t data[300];
+    srand(7);
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)rand();
+    }
+
+    // Step 1: Every supported kernel must match the document's algorithm bit for bit
+    bool all_match = true;
+    for (size_t k = 0; k < COMCHIP_CHECKSUM_KERNEL_COUNT; k++) {
+        const ComchipChecksumKernel* kernel = &comchip_checksum_kernels[k];
+        if (!comchip_checksum_kernel_supported(kernel)) {
+            printf("Kernel %-7s not supported on this CPU\n", kernel->name);
+            continue;
+        }
+        bool match = true;
+        for (unsigned cid = 0; cid < 256; cid += 5) {
+            for (uint8_t len = 0; len < 255; len++) {
+                if (kernel->checksum((uint8_t)cid, data, len) != calculate_checksum((uint8_t)cid, data, len)) {
+                    match = false;
+                }
+            }
+        }
+        printf("Kernel %-7s %s\n", kernel->name, match ? "matches calculate_checksum" : "MISMATCH");
+        all_match = all_match && match;
+    }
+
+    // Step 2: Batch verification of 6-byte frames, one in eight corrupted
+    uint8_t* frames = malloc((size_t)BATCH_FRAMES * COMCHIP_STATUS_FRAME_LEN);
+    uint8_t* ok = malloc(BATCH_FRAMES);
+    if (!frames || !ok) {
+        return 1;
+    }
+    for (size_t i = 0; i < BATCH_FRAMES; i++) {
+        uint8_t* f = frames + i * COMCHIP_STATUS_FRAME_LEN;
+        f[0] = COMCHIP_SYNC_BYTE;
+        f[1] = COMCHIP_CID_GET_STATUS_RESP;
+        f[2] = (uint8_t)rand();
+        f[3] = (uint8_t)rand();
+        f[4] = (uint8_t)rand();
+        f[5] = calculate_checksum(f[1], &f[2], COMCHIP_STATUS_FRAME_LEN - 3);
+        if (i % 8 == 0) {
+            f[5] ^= 0x01;
+        }
+    }
+
+    comchip_verify_scalar(frames, BATCH_FRAMES, COMCHIP_STATUS_FRAME_LEN, ok); // Warm up caches
+    for (size_t k = 0; k < COMCHIP_CHECKSUM_KERNEL_COUNT; k++) {
+        const ComchipChecksumKernel* kernel = &comchip_checksum_kernels[k];
+        if (!comchip_checksum_kernel_supported(kernel)) {
+            continue;
+        }
+        clock_t start = clock();
+        size_t valid = kernel->verify(frames, BATCH_FRAMES, COMCHIP_STATUS_FRAME_LEN, ok);
+        double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+        printf("Kernel %-7s %zu/%u frames valid, %.1f Mframes/s\n", kernel->name, valid, BATCH_FRAMES,
+               seconds > 0 ? BATCH_FRAMES / seconds / 1e6 : 0.0);
+        all_match = all_match && valid == BATCH_FRAMES - BATCH_FRAMES / 8;
+    }
+
+    printf("Selected kernel: %s\n", comchip_checksum_kernel()->name);
+    free(frames);
+    free(ok);
+    return all_match ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+// Change-only emission behind real ingestion. 64 pseudo-terminal ports
+// stand in for batteries answering a status poll 200 times:
+//     0-47   healthy, the same frame every time
+//     48-59  healthy, voltage jitters by up to +-4 mV
+//     60-61  discharging, 20 mV less every cycle
+//     62     7-byte frames; Byte2 flips to "discharged" halfway
+//     63     raises under voltage halfway
+// The same workload runs without and with a 5 mV deadband; "records" is
+// what a downstream serializer or store would have had to handle.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "comchip_frame.h"
+#include "comchip_ingest.h"
+#include "comchip_dedup.h"
+
+#define EXAMPLE_PORTS  64
+#define EXAMPLE_CYCLES 200
+
+static uint64_t records;
+
+static void count_records(void* ctx, const ComchipStatusEvent* events, size_t n) {
+    (void)ctx;
+    (void)events;
+    records += n;
+}
+
+// Answer of battery `i` in `cycle`, encoded into out; returns its length
+static size_t sim_frame(int i, int cycle, uint8_t* out) {
+    uint8_t status = i == 63 && cycle >= EXAMPLE_CYCLES / 2 ? STATUS_BIT_UNDER_VOLTAGE : 0;
+    int mV = 38000 + i;
+    if (i >= 48 && i < 60) {
+        mV += rand() % 9 - 4;
+    } else if (i == 60 || i == 61) {
+        mV -= 20 * cycle;
+    }
+    uint8_t payload[4] = { status, (uint8_t)(mV >> 8), (uint8_t)mV, cycle >= EXAMPLE_CYCLES / 2 };
+    size_t plen = i == 62 ? 4 : 3;
+    return comchip_encode_frames(out, 16, COMCHIP_CID_GET_STATUS_RESP, payload, plen, 1);
+}
+
+static int run(uint16_t deadband_mV) {
+    static ComchipIngest ingest;
+    static ComchipDedup dedup;
+    static int masters[EXAMPLE_PORTS];
+
+    records = 0;
+    srand(3);
+    if (comchip_dedup_init(&dedup, EXAMPLE_PORTS, deadband_mV, count_records, NULL, NULL) < 0 ||
+        comchip_ingest_init(&ingest, COMCHIP_INGEST_AUTO, EXAMPLE_PORTS, comchip_dedup_on_batch,
+                            comchip_dedup_on_closed, &dedup) < 0) {
+        perror("init");
+        return -1;
+    }
+    for (int i = 0; i < EXAMPLE_PORTS; i++) {
+        int slave;
+        size_t layout = i == 62 ? COMCHIP_STATUS_FRAME_LEN_BYTE2 : COMCHIP_STATUS_FRAME_LEN;
+        if (comchip_pty_open(&masters[i], &slave, COMCHIP_SERIAL_VMIN) < 0 ||
+            comchip_ingest_add(&ingest, slave, layout) < 0) {
+            perror("port setup");
+            return -1;
+        }
+    }
+    comchip_ingest_run_once(&ingest, 0); // Posts the first reads for io_uring
+
+    for (int cycle = 0; cycle < EXAMPLE_CYCLES; cycle++) {
+        for (int i = 0; i < EXAMPLE_PORTS; i++) {
+            uint8_t frame[16];
+            size_t len = sim_frame(i, cycle, frame);
+            if (write(masters[i], frame, len) != (ssize_t)len) {
+                perror("write");
+                return -1;
+            }
+        }
+        uint64_t expected = (uint64_t)(cycle + 1) * EXAMPLE_PORTS;
+        while (dedup.frames < expected && comchip_ingest_run_once(&ingest, 100) >= 0) {
+        }
+    }
+
+    uint64_t now = comchip_now_ns();
+    uint64_t stale = 0;
+    for (int i = 0; i < EXAMPLE_PORTS; i++) {
+        stale += now - comchip_dedup_last_seen(&dedup, i) > COMCHIP_NS_PER_S;
+    }
+    printf("Deadband %u mV | Frames: %llu | Records: %llu (%.1f%%) | Suppressed: %llu | Silent > 1 s: %llu\n",
+           deadband_mV, (unsigned long long)dedup.frames, (unsigned long long)records,
+           100.0 * records / dedup.frames, (unsigned long long)dedup.suppressed, (unsigned long long)stale);
+
+    comchip_ingest_close(&ingest);
+    for (int i = 0; i < EXAMPLE_PORTS; i++) {
+        close(masters[i]);
+    }
+    comchip_dedup_free(&dedup);
+    return 0;
+}
+
+int main() {
+    if (run(0) < 0 || run(5) < 0) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+// One-pass decode of a stream that mixes several COMChip response types.
+// Besides the built-in 'Get Battery Status' response (0x81), this example
+// registers a handler for a second response type (CID 0x83, a 2-byte
+// firmware version) to show how new CIDs plug into the dispatch table.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "comchip_dispatch.h"
+#include "comchip_frame.h"
+
+#define EXAMPLE_CID_VERSION_RESP 0x83
+#define EXAMPLE_VERSION_FRAME_LEN 5 // SYNC + CID + Major + Minor + Checksum
+
+static void print_status(void* ctx, const BatteryStatusData* data) {
+    (void)ctx;
+    printf("Status  | Battery Voltage: %u mV | Under Voltage: %s\n",
+           data->battery_voltage_mV, data->is_under_voltage ? "YES" : "NO");
+}
+
+static void print_version(void* ctx, const uint8_t* frame, uint8_t frame_len) {
+    (void)ctx;
+    (void)frame_len;
+    printf("Version | Firmware %u.%u\n", frame[2], frame[3]);
+}
+
+int main() {
+    // Status | noise | Version | Status (under voltage) | unknown CID 0x90 | Version
+    uint8_t stream[] = {
+        COMCHIP_FRAME_BYTES(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE),
+        0x00, 0x55,
+        COMCHIP_FRAME_BYTES(EXAMPLE_CID_VERSION_RESP, 0x02, 0x07),
+        COMCHIP_FRAME_BYTES(COMCHIP_CID_GET_STATUS_RESP, 0x40, 0x96, 0xFE),
+        COMCHIP_FRAME_BYTES(0x90, 0x01),
+        COMCHIP_FRAME_BYTES(EXAMPLE_CID_VERSION_RESP, 0x02, 0x08),
+    };
+
+    ComchipDispatch dispatch;
+    comchip_dispatch_init(&dispatch);
+
+    ComchipStatusHandler status_handler = { print_status, NULL };
+    comchip_dispatch_register_status(&dispatch, COMCHIP_STATUS_FRAME_LEN, &status_handler);
+    comchip_dispatch_register(&dispatch, EXAMPLE_CID_VERSION_RESP, EXAMPLE_VERSION_FRAME_LEN,
+                              NULL, print_version, NULL);
+
+    // Receive in 4-byte reads; unconsumed bytes of a split frame are kept
+    // at the front of the buffer and decoded once the rest arrives
+    uint8_t buf[64];
+    size_t held = 0;
+    for (size_t offset = 0; offset < sizeof(stream); offset += 4) {
+        size_t n = sizeof(stream) - offset < 4 ? sizeof(stream) - offset : 4;
+        memcpy(buf + held, stream + offset, n);
+        held += n;
+
+        size_t used = comchip_dispatch_feed(&dispatch, buf, held);
+        memmove(buf, buf + used, held - used);
+        held -= used;
+    }
+
+    printf("\nStatus frames: %llu\n", (unsigned long long)dispatch.entries[COMCHIP_CID_GET_STATUS_RESP].frames);
+    printf("Version frames: %llu\n", (unsigned long long)dispatch.entries[EXAMPLE_CID_VERSION_RESP].frames);
+    printf("Unknown CIDs: %llu\n", (unsigned long long)dispatch.unknown_cids);
+    printf("Bytes skipped: %llu\n", (unsigned long long)dispatch.bytes_skipped);
+    return 0;
+}
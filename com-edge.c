@@ -0,0 +1,86 @@
+// Alarm edge detection over one simulated hour of 256 batteries polled ten
+// times a second. Almost all of them are healthy throughout:
+//     3    reports a battery error from minute 20 on
+//     17   is not supported
+//     40   sits on the under-voltage threshold for minutes 10-12 and
+//          flickers on about one sample in five, then stays under voltage
+//     41   flickers the same way for minutes 30-32, then recovers
+// The first run reports every change; the second debounces them by one
+// second, which keeps the flicker out and the real transitions in.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "comchip_edge.h"
+
+#define EXAMPLE_DEVICES 256
+#define EXAMPLE_RATE_NS (100 * COMCHIP_NS_PER_MS)
+#define EXAMPLE_RUN_NS  (3600 * COMCHIP_NS_PER_S)
+
+static bool verbose;
+
+static const char* flag_name(uint8_t flag) {
+    switch (flag) {
+    case STATUS_BIT_BATTERY_ERROR: return "battery error";
+    case STATUS_BIT_UNDER_VOLTAGE: return "under voltage";
+    case STATUS_BIT_NOT_SUPPORTED: return "not supported";
+    default:                       return "?";
+    }
+}
+
+static void on_edge(void* ctx, const ComchipEdgeEvent* ev) {
+    (void)ctx;
+    if (verbose) {
+        printf("  %7.1f s  battery %3u  %-13s %d -> %d\n", ev->timestamp_ns / 1e9, ev->port, flag_name(ev->flag),
+               ev->old_value, ev->new_value);
+    }
+}
+
+static void sim_state(uint32_t d, uint64_t t, BatteryStatusData* data) {
+    double m = t / 60e9;
+    data->battery_voltage_mV = 38000;
+    data->has_battery_error = d == 3 && m >= 20;
+    data->is_battery_supported = d != 17;
+    data->is_under_voltage = false;
+    if (d == 40 && m >= 10) {
+        data->is_under_voltage = m >= 12 || rand() % 5 == 0;
+    }
+    if (d == 41 && m >= 30 && m < 32) {
+        data->is_under_voltage = rand() % 5 == 0;
+    }
+}
+
+static void run(uint64_t debounce_ns) {
+    ComchipEdgeDetector d;
+    if (comchip_edge_init(&d, EXAMPLE_DEVICES, debounce_ns, on_edge, NULL) < 0) {
+        perror("comchip_edge_init");
+        exit(1);
+    }
+    srand(7);
+    uint64_t spent = 0;
+    for (uint64_t t = 0; t < EXAMPLE_RUN_NS; t += EXAMPLE_RATE_NS) {
+        BatteryStatusData batch[EXAMPLE_DEVICES] = {0};
+        for (uint32_t i = 0; i < EXAMPLE_DEVICES; i++) {
+            sim_state(i, t, &batch[i]);
+        }
+        uint64_t start = comchip_now_ns();
+        for (uint32_t i = 0; i < EXAMPLE_DEVICES; i++) {
+            comchip_edge_feed(&d, i, &batch[i], t);
+        }
+        spent += comchip_now_ns() - start;
+    }
+    printf("Debounce %4llu ms: %llu statuses -> %llu events (%.0fx fewer), %llu bounces, %.1f ns per status\n",
+           (unsigned long long)(debounce_ns / COMCHIP_NS_PER_MS), (unsigned long long)d.samples,
+           (unsigned long long)d.events, (double)d.samples / (d.events ? d.events : 1),
+           (unsigned long long)d.bounces, (double)spent / d.samples);
+    comchip_edge_free(&d);
+}
+
+int main() {
+    run(0);
+    verbose = true;
+    run(COMCHIP_NS_PER_S);
+    return 0;
+}
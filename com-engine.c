@@ -0,0 +1,204 @@
+// Pipelined polling of simulated batteries. Each battery sits behind a
+// pseudo-terminal pair: the engine writes 'Get Battery Status' requests into
+// the slave end, and a small simulator on the master end answers every
+// request after a fixed link delay. Battery 6 loses every fourth request and
+// battery 7 never answers, so timeouts, retries, give-ups and the stalled-link
+// watchdog show up too.
+// The same run is made with one request in flight per battery (classic
+// polling) and with four. A last check fills a port's output queue behind
+// the io_uring backend and makes sure polling it returns straight away.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "comchip_engine.h"
+#include "comchip_ingest.h"
+
+#define EXAMPLE_DEVICES    8
+#define EXAMPLE_RUN_NS     (500 * COMCHIP_NS_PER_MS)
+#define EXAMPLE_LINK_DELAY (2 * COMCHIP_NS_PER_MS) // Request to response on the wire
+#define EXAMPLE_QUEUE      64
+#define EXAMPLE_WATCHDOG   (100 * COMCHIP_NS_PER_MS)
+
+// --- Battery Simulator (master ends) ---
+typedef struct {
+    int      fd;
+    uint64_t due[EXAMPLE_QUEUE]; // Response times of accepted requests
+    uint32_t head, count;
+    uint32_t received;
+    uint8_t  partial[COMCHIP_STATUS_REQ_FRAME_LEN];
+    uint8_t  partial_len;
+} SimBattery;
+
+static void sim_receive(SimBattery* b, int index, uint64_t now) {
+    uint8_t buf[256];
+    ssize_t n;
+    while ((n = read(b->fd, buf, sizeof(buf))) > 0) {
+        for (ssize_t i = 0; i < n; i++) {
+            b->partial[b->partial_len++] = buf[i];
+            if (b->partial_len < COMCHIP_STATUS_REQ_FRAME_LEN) {
+                continue;
+            }
+            b->partial_len = 0;
+            if (comchip_status_req_validate(b->partial, COMCHIP_STATUS_REQ_FRAME_LEN).error != COMCHIP_OK) {
+                continue;
+            }
+            b->received++;
+            bool lost = index == 7 || (index == 6 && b->received % 4 == 0);
+            if (!lost && b->count < EXAMPLE_QUEUE) {
+                b->due[(b->head + b->count++) % EXAMPLE_QUEUE] = now + EXAMPLE_LINK_DELAY;
+            }
+        }
+    }
+}
+
+static uint64_t sim_respond(SimBattery* b, uint64_t now) {
+    static const uint8_t response[] = COMCHIP_FRAME(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE);
+    while (b->count && b->due[b->head] <= now) {
+        if (write(b->fd, response, sizeof(response)) != (ssize_t)sizeof(response)) {
+            break;
+        }
+        b->head = (b->head + 1) % EXAMPLE_QUEUE;
+        b->count--;
+    }
+    return b->count ? b->due[b->head] : UINT64_MAX;
+}
+
+// --- Engine Side ---
+static uint64_t failures_reported;
+
+static void on_response(void* ctx, uint32_t dev, const BatteryStatusData* data, uint64_t rtt_ns) {
+    (void)ctx;
+    (void)dev;
+    (void)data;
+    (void)rtt_ns;
+}
+
+static void on_failure(void* ctx, uint32_t dev) {
+    (void)ctx;
+    (void)dev;
+    failures_reported++;
+}
+
+static int run(uint8_t window) {
+    static ComchipIngest ingest;
+    static ComchipEngine engine;
+    SimBattery sims[EXAMPLE_DEVICES];
+
+    if (comchip_engine_init(&engine, EXAMPLE_DEVICES, on_response, on_failure, NULL) < 0 ||
+        comchip_ingest_init(&ingest, COMCHIP_INGEST_AUTO, EXAMPLE_DEVICES, comchip_engine_on_batch, NULL, &engine) < 0) {
+        perror("setup");
+        return -1;
+    }
+    comchip_engine_set_watchdog(&engine, EXAMPLE_WATCHDOG, NULL);
+    for (int i = 0; i < EXAMPLE_DEVICES; i++) {
+        int slave;
+        memset(&sims[i], 0, sizeof(sims[i]));
+        if (comchip_pty_open(&sims[i].fd, &slave, COMCHIP_SERIAL_VMIN) < 0) {
+            perror("comchip_pty_open");
+            return -1;
+        }
+        fcntl(sims[i].fd, F_SETFL, fcntl(sims[i].fd, F_GETFL) | O_NONBLOCK);
+        int32_t dev = comchip_ingest_add(&ingest, slave, COMCHIP_STATUS_FRAME_LEN);
+        comchip_engine_attach(&engine, (uint32_t)dev, slave, window);
+        comchip_engine_poll(&engine, (uint32_t)dev, COMCHIP_POLL_CONTINUOUS);
+    }
+
+    uint64_t start = comchip_now_ns();
+    uint64_t now = start;
+    while (now - start < EXAMPLE_RUN_NS) {
+        int timeout = comchip_engine_tick(&engine); // Deadlines, backoff ends and watchdogs
+
+        now = comchip_now_ns();
+        uint64_t sim_next = UINT64_MAX;
+        for (int i = 0; i < EXAMPLE_DEVICES; i++) {
+            sim_receive(&sims[i], i, now);
+            uint64_t due = sim_respond(&sims[i], now);
+            sim_next = due < sim_next ? due : sim_next;
+        }
+        int sim_timeout = comchip_timeout_ms(sim_next, now);
+        if (sim_timeout >= 0 && (timeout < 0 || sim_timeout < timeout)) {
+            timeout = sim_timeout;
+        }
+        comchip_ingest_run_once(&ingest, timeout > 1 ? 1 : timeout); // The simulator shares this thread
+        now = comchip_now_ns();
+    }
+
+    printf("Window %u (%s backend):\n", window, ingest.backend->name);
+    printf("Dev | Sent  | Resp  | Polls/s | RTT min/avg/max (ms) | Timeouts | Failures | Unmatched | Stalls\n");
+    for (int i = 0; i < EXAMPLE_DEVICES; i++) {
+        const ComchipDevice* d = &engine.devices[i];
+        double avg = d->responses ? (double)d->rtt_sum_ns / d->responses / 1e6 : 0.0;
+        printf("%3d | %5llu | %5llu | %7.0f | %5.2f / %5.2f / %5.2f  | %8llu | %8llu | %9llu | %6llu\n", i,
+               (unsigned long long)d->requests_sent, (unsigned long long)d->responses,
+               d->responses / (EXAMPLE_RUN_NS / 1e9),
+               d->responses ? d->rtt_min_ns / 1e6 : 0.0, avg, d->rtt_max_ns / 1e6,
+               (unsigned long long)d->timeouts, (unsigned long long)d->failures,
+               (unsigned long long)d->unmatched, (unsigned long long)d->stalls);
+    }
+    printf("\n");
+
+    comchip_ingest_close(&ingest);
+    comchip_engine_free(&engine);
+    for (int i = 0; i < EXAMPLE_DEVICES; i++) {
+        close(sims[i].fd);
+    }
+    return 0;
+}
+
+// --- Full Output Queue ---
+// Nobody drains the master end, so the slave's output queue fills up; the
+// engine's write must then fail with EAGAIN instead of blocking the loop.
+static int check_full_queue(void) {
+    static ComchipIngest ingest;
+    static ComchipEngine engine;
+    int master, slave;
+
+    if (comchip_ingest_init(&ingest, COMCHIP_INGEST_URING, 1, comchip_engine_on_batch, NULL, &engine) < 0) {
+        perror("io_uring backend unavailable, full-queue check skipped");
+        return 0;
+    }
+    if (comchip_engine_init(&engine, 1, on_response, NULL, NULL) < 0 ||
+        comchip_pty_open(&master, &slave, COMCHIP_SERIAL_VMIN) < 0) {
+        perror("setup");
+        return -1;
+    }
+    int32_t dev = comchip_ingest_add(&ingest, slave, COMCHIP_STATUS_FRAME_LEN);
+    if (dev < 0 || !comchip_engine_attach(&engine, (uint32_t)dev, slave, 4)) {
+        perror("attach");
+        return -1;
+    }
+    uint8_t junk[256] = {0};
+    size_t queued = 0;
+    ssize_t n;
+    while ((n = write(slave, junk, sizeof(junk))) > 0) {
+        queued += (size_t)n;
+    }
+    if (errno != EAGAIN) {
+        perror("write");
+        return -1;
+    }
+
+    uint64_t start = comchip_now_ns();
+    comchip_engine_poll(&engine, (uint32_t)dev, COMCHIP_POLL_CONTINUOUS);
+    comchip_engine_tick(&engine);
+    uint64_t took = comchip_now_ns() - start;
+    uint64_t sent = engine.devices[dev].requests_sent;
+    printf("Full output queue (%s backend, %zu bytes queued): poll returned in %.1f us, %llu requests sent\n",
+           ingest.backend->name, queued, took / 1e3, (unsigned long long)sent);
+
+    comchip_ingest_close(&ingest);
+    comchip_engine_free(&engine);
+    close(master);
+    return took < 100 * COMCHIP_NS_PER_MS && sent == 0 ? 0 : -1;
+}
+
+int main() {
+    if (run(1) < 0 || run(4) < 0 || check_full_queue() < 0) {
+        return 1;
+    }
+    printf("Give-ups reported: %llu\n", (unsigned long long)failures_reported);
+    return 0;
+}
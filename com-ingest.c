@@ -0,0 +1,93 @@
+// The same many-port workload through each ingestion backend. Pseudo-terminal
+// pairs stand in for the serial ports; every cycle each battery answers once
+// and the backend decodes all answers on one thread.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+
+#include "comchip_frame.h"
+#include "comchip_ingest.h"
+
+#define EXAMPLE_PORTS  500
+#define EXAMPLE_CYCLES 50
+
+static void count_frames(void* ctx, const ComchipStatusEvent* events, size_t n) {
+    (void)events;
+    *(uint64_t*)ctx += n;
+}
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static int run(ComchipIngestKind kind) {
+    static const uint8_t frame[] = COMCHIP_FRAME(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE);
+    static ComchipIngest ingest;
+    static int masters[EXAMPLE_PORTS];
+    uint64_t frames = 0;
+
+    if (comchip_ingest_init(&ingest, kind, EXAMPLE_PORTS, count_frames, NULL, &frames) < 0) {
+        perror("comchip_ingest_init");
+        return -1;
+    }
+    for (int i = 0; i < EXAMPLE_PORTS; i++) {
+        int slave;
+        if (comchip_pty_open(&masters[i], &slave, COMCHIP_SERIAL_VMIN) < 0 ||
+            comchip_ingest_add(&ingest, slave, COMCHIP_STATUS_FRAME_LEN) < 0) {
+            perror("port setup");
+            return -1;
+        }
+    }
+    comchip_ingest_run_once(&ingest, 0); // Posts the first reads for io_uring
+
+    double start = now_ms();
+    uint64_t loops = 0;
+    for (int cycle = 0; cycle < EXAMPLE_CYCLES; cycle++) {
+        for (int i = 0; i < EXAMPLE_PORTS; i++) {
+            if (write(masters[i], frame, sizeof(frame)) != (ssize_t)sizeof(frame)) {
+                perror("write");
+                return -1;
+            }
+        }
+        uint64_t expected = (uint64_t)(cycle + 1) * EXAMPLE_PORTS;
+        while (frames < expected && comchip_ingest_run_once(&ingest, 100) >= 0) {
+            loops++;
+        }
+    }
+    double elapsed = now_ms() - start;
+
+    printf("%-8s | Frames: %llu | Loop iterations: %llu | %.1f ms\n", ingest.backend->name,
+           (unsigned long long)frames, (unsigned long long)loops, elapsed);
+    if (ingest.backend == &comchip_ingest_uring_backend) {
+        printf("         | io_uring_enter() calls: %llu for %llu completions\n",
+               (unsigned long long)ingest.impl.uring.enters, (unsigned long long)ingest.impl.uring.completions);
+    } else {
+        uint64_t reads = 0;
+        for (int i = 0; i < EXAMPLE_PORTS; i++) {
+            reads += ingest.impl.reactor.ports[i].port.reads;
+        }
+        printf("         | epoll wakeups: %llu, read() calls returning data: %llu (plus one EAGAIN read per drain)\n",
+               (unsigned long long)ingest.impl.reactor.wakeups, (unsigned long long)reads);
+    }
+
+    comchip_ingest_close(&ingest);
+    for (int i = 0; i < EXAMPLE_PORTS; i++) {
+        close(masters[i]);
+    }
+    return 0;
+}
+
+int main() {
+    if (run(COMCHIP_INGEST_AUTO) < 0) {
+        return 1;
+    }
+    if (run(COMCHIP_INGEST_EPOLL) < 0) {
+        return 1;
+    }
+    return 0;
+}
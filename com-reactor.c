@@ -0,0 +1,106 @@
+// Many COMChip links on one thread. Pseudo-terminal pairs stand in for the
+// serial ports; the example plays every battery's side by writing responses
+// into the master ends while one reactor drains all slave ends.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "comchip_frame.h"
+#include "comchip_reactor.h"
+
+#define EXAMPLE_PORTS   200
+#define EXAMPLE_CYCLES  20
+#define EXAMPLE_CHATTY_FRAMES 2000 // Backlog on port 0, more than one read budget
+
+typedef struct {
+    uint64_t frames;
+    uint64_t under_voltage;
+    uint64_t batches;
+    size_t   largest_batch;
+    uint32_t closed;
+} Totals;
+
+static void on_batch(void* ctx, const ComchipStatusEvent* events, size_t n) {
+    Totals* t = (Totals*)ctx;
+    t->batches++;
+    t->frames += n;
+    if (n > t->largest_batch) {
+        t->largest_batch = n;
+    }
+    for (size_t i = 0; i < n; i++) {
+        t->under_voltage += events[i].data.is_under_voltage;
+    }
+}
+
+static void on_closed(void* ctx, uint32_t port) {
+    Totals* t = (Totals*)ctx;
+    t->closed++;
+    printf("Port %u hung up\n", port);
+}
+
+int main() {
+    static const uint8_t good[] = COMCHIP_FRAME(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE);
+    static const uint8_t low[] = COMCHIP_FRAME(COMCHIP_CID_GET_STATUS_RESP, 0x40, 0x6D, 0x60);
+
+    Totals totals;
+    memset(&totals, 0, sizeof(totals));
+
+    static ComchipReactor reactor;
+    if (comchip_reactor_init(&reactor, EXAMPLE_PORTS, on_batch, on_closed, &totals) < 0) {
+        perror("comchip_reactor_init");
+        return 1;
+    }
+
+    int masters[EXAMPLE_PORTS];
+    for (int i = 0; i < EXAMPLE_PORTS; i++) {
+        int slave;
+        if (comchip_pty_open(&masters[i], &slave, COMCHIP_SERIAL_VMIN) < 0 ||
+            comchip_reactor_add(&reactor, slave, COMCHIP_STATUS_FRAME_LEN) < 0) {
+            perror("port setup");
+            return 1;
+        }
+    }
+
+    // A chatty link with a large backlog shares the loop with the others
+    for (int k = 0; k < EXAMPLE_CHATTY_FRAMES; k++) {
+        if (write(masters[0], good, sizeof(good)) != (ssize_t)sizeof(good)) {
+            perror("write");
+            return 1;
+        }
+    }
+
+    // Every battery answers once per cycle; every tenth one reports under voltage
+    uint64_t sent = EXAMPLE_CHATTY_FRAMES;
+    for (int cycle = 0; cycle < EXAMPLE_CYCLES; cycle++) {
+        for (int i = 1; i < EXAMPLE_PORTS; i++) {
+            const uint8_t* f = i % 10 == 0 ? low : good;
+            if (write(masters[i], f, COMCHIP_STATUS_FRAME_LEN) != COMCHIP_STATUS_FRAME_LEN) {
+                perror("write");
+                return 1;
+            }
+            sent++;
+        }
+        while (comchip_reactor_run_once(&reactor, 10) > 0 || reactor.ready_count) {
+        }
+    }
+
+    close(masters[EXAMPLE_PORTS - 1]);
+    while (totals.closed == 0 && comchip_reactor_run_once(&reactor, 100) >= 0) {
+    }
+
+    printf("\nFrames sent: %llu\n", (unsigned long long)sent);
+    printf("Frames delivered: %llu (under voltage: %llu)\n",
+           (unsigned long long)totals.frames, (unsigned long long)totals.under_voltage);
+    printf("Batches: %llu (largest %zu)\n", (unsigned long long)totals.batches, totals.largest_batch);
+    printf("epoll wakeups: %llu | Rounds: %llu | Budget requeues: %llu\n",
+           (unsigned long long)reactor.wakeups, (unsigned long long)reactor.rounds,
+           (unsigned long long)reactor.requeues);
+
+    comchip_reactor_close(&reactor);
+    for (int i = 0; i < EXAMPLE_PORTS - 1; i++) {
+        close(masters[i]);
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Splitting ingestion from decoding with an SPSC byte ring. The I/O thread
+// copies bursts of received bytes into the ring (standing in for read()
+// calls, see comchip_ring_read_fd()); the decode thread parses them in place.
+// The decoder is made to stall now and then: the ring absorbs the backlog
+// and the I/O thread keeps going.
+// Build with -pthread.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "comchip_frame.h"
+#include "comchip_ring.h"
+
+#define EXAMPLE_FRAMES     (4u << 20)
+#define EXAMPLE_RING_SIZE  (2u << 20)
+#define EXAMPLE_BURST      4096
+
+static uint8_t* source;
+static size_t   source_len;
+static volatile bool producer_done;
+
+static void* io_thread(void* arg) {
+    ComchipRing* ring = (ComchipRing*)arg;
+    size_t offset = 0;
+    uint32_t seed = 1;
+
+    while (offset < source_len) {
+        seed = seed * 1103515245u + 12345u;
+        size_t burst = 1 + (seed >> 8) % EXAMPLE_BURST; // Uneven, like read() results
+        if (burst > source_len - offset) {
+            burst = source_len - offset;
+        }
+
+        size_t avail;
+        uint8_t* span = comchip_ring_write_span(ring, &avail);
+        if (!span) {
+            sched_yield(); // Ring full: only happens if the decoder falls a whole ring behind
+            continue;
+        }
+        size_t n = burst < avail ? burst : avail;
+        memcpy(span, source + offset, n);
+        comchip_ring_write_commit(ring, n);
+        offset += n;
+    }
+    __atomic_store_n(&producer_done, true, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+static double now_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main() {
+    static const uint8_t frame[] = COMCHIP_FRAME(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE);
+    source_len = (size_t)EXAMPLE_FRAMES * sizeof(frame);
+    source = (uint8_t*)malloc(source_len);
+    for (size_t i = 0; i < EXAMPLE_FRAMES; i++) {
+        memcpy(source + i * sizeof(frame), frame, sizeof(frame));
+    }
+
+    static ComchipRing ring;
+    if (comchip_ring_init(&ring, EXAMPLE_RING_SIZE, COMCHIP_RING_HUGE_PAGES) < 0) {
+        perror("comchip_ring_init");
+        return 1;
+    }
+
+    ComchipStream decoder;
+    comchip_stream_init(&decoder, NULL, NULL);
+    comchip_stream_set_layout(&decoder, COMCHIP_STATUS_FRAME_LEN);
+
+    double start = now_s();
+    pthread_t io;
+    pthread_create(&io, NULL, io_thread, &ring);
+
+    size_t frames = 0;
+    uint64_t passes = 0;
+    for (;;) {
+        bool done = __atomic_load_n(&producer_done, __ATOMIC_ACQUIRE);
+        frames += comchip_ring_decode(&ring, &decoder);
+        if (done) {
+            break; // Everything written before `done` was set has been decoded
+        }
+        if (++passes % 64 == 0) {
+            struct timespec stall = { 0, 200000 }; // A slow consumer: 0.2 ms
+            nanosleep(&stall, NULL);
+        }
+    }
+    pthread_join(io, NULL);
+    double elapsed = now_s() - start;
+
+    printf("Ring: %zu KiB, %s pages\n", ring.cap >> 10, ring.huge ? "huge" : "normal");
+    printf("Frames decoded: %zu of %u\n", frames, EXAMPLE_FRAMES);
+    printf("Throughput: %.0f MB/s\n", source_len / elapsed / 1e6);
+    printf("High-water mark: %zu bytes (%.1f%%)\n", ring.high_water, 100.0 * ring.high_water / ring.cap);
+    printf("Producer found ring full: %llu times\n", (unsigned long long)ring.full);
+
+    comchip_ring_free(&ring);
+    free(source);
+    return 0;
+}
@@ -0,0 +1,77 @@
+// Offline decode of a recorded line capture using the vectorized frame scanner
+// Usage: com-scan [capture.bin]   (without a file, a synthetic capture is generated)
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "comchip_scan.h"
+
+static void count_frame(void* ctx, size_t offset, const BatteryStatusData* data) {
+    (void)offset;
+    (void)data;
+    (*(size_t*)ctx)++;
+}
+
+// Load a whole capture file into memory
+static uint8_t* load_capture(const char* path, size_t* len) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        printf("Error: cannot open %s\n", path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t* buf = malloc(size > 0 ? (size_t)size : 1u);
+    *len = buf ? fread(buf, 1, (size_t)(size > 0 ? size : 0), f) : 0;
+    fclose(f);
+    return buf;
+}
+
+// Build a capture of good frames separated by random line noise
+static uint8_t* synth_capture(size_t len) {
+    uint8_t* buf = malloc(len);
+    size_t i = 0;
+    srand(1);
+    while (buf && i + COMCHIP_STATUS_FRAME_LEN <= len) {
+        if (rand() % 8 == 0) {
+            buf[i++] = (uint8_t)rand();
+            continue;
+        }
+        buf[i] = COMCHIP_SYNC_BYTE;
+        buf[i + 1] = COMCHIP_CID_GET_STATUS_RESP;
+        buf[i + 2] = (uint8_t)(rand() & 0xE0);
+        buf[i + 3] = (uint8_t)rand();
+        buf[i + 4] = (uint8_t)rand();
+        buf[i + 5] = calculate_checksum(buf[i + 1], &buf[i + 2], COMCHIP_STATUS_FRAME_LEN - 3);
+        i += COMCHIP_STATUS_FRAME_LEN;
+    }
+    while (buf && i < len) {
+        buf[i++] = 0;
+    }
+    return buf;
+}
+
+int main(int argc, char** argv) {
+    size_t len = 256u << 20;
+    uint8_t* capture = argc > 1 ? load_capture(argv[1], &len) : synth_capture(len);
+    if (!capture) {
+        return 1;
+    }
+
+    size_t frames = 0;
+    clock_t start = clock();
+    comchip_scan_decode(capture, len, count_frame, &frames);
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    printf("Scanned %zu bytes, decoded %zu frames\n", len, frames);
+    if (seconds > 0) {
+        printf("Throughput: %.2f GB/s\n", (double)len / seconds / 1e9);
+    }
+
+    free(capture);
+    return 0;
+}
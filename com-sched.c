@@ -0,0 +1,131 @@
+// Adaptive polling of simulated batteries. Each battery sits behind a
+// pseudo-terminal pair and answers status requests with its current state:
+//     0-3  healthy, steady voltage
+//     4    discharging, voltage falling
+//     5    under voltage
+//     6    healthy until halfway, then reports a battery error
+//     7    healthy
+// The scheduler polls the critical ones often and backs off on the rest;
+// the second run squeezes everything into a small bandwidth budget.
+// Intervals are scaled down from the defaults so the run takes seconds.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "comchip_ingest.h"
+#include "comchip_sched.h"
+
+#define EXAMPLE_DEVICES 8
+#define EXAMPLE_RUN_NS  (3 * COMCHIP_NS_PER_S)
+
+static uint64_t run_start;
+
+// --- Battery Simulator (master ends) ---
+static void sim_state(int index, uint64_t now, uint8_t* status, uint16_t* mV) {
+    double t = (now - run_start) / 1e9;
+    *status = 0;
+    *mV = 38654;
+    if (index == 4) {
+        *mV = (uint16_t)(38654 - 200 * t); // 200 mV/s
+    } else if (index == 5) {
+        *status = STATUS_BIT_UNDER_VOLTAGE;
+        *mV = 28000;
+    } else if (index == 6 && t > EXAMPLE_RUN_NS / 2e9) {
+        *status = STATUS_BIT_BATTERY_ERROR;
+    }
+}
+
+static void sim_answer(int fd, int index, uint64_t now) {
+    uint8_t req[64];
+    ssize_t n = read(fd, req, sizeof(req));
+    for (ssize_t i = 0; i + COMCHIP_STATUS_REQ_FRAME_LEN <= n; i += COMCHIP_STATUS_REQ_FRAME_LEN) {
+        uint8_t status;
+        uint16_t mV;
+        sim_state(index, now, &status, &mV);
+        uint8_t payload[3] = { status, (uint8_t)(mV >> 8), (uint8_t)mV };
+        uint8_t resp[COMCHIP_STATUS_FRAME_LEN];
+        comchip_encode_frames(resp, sizeof(resp), COMCHIP_CID_GET_STATUS_RESP, payload, sizeof(payload), 1);
+        if (write(fd, resp, sizeof(resp)) != (ssize_t)sizeof(resp)) {
+            perror("write");
+        }
+    }
+}
+
+static const char* class_name(ComchipSchedClass cls) {
+    return cls == COMCHIP_SCHED_ALARM ? "ALARM" : cls == COMCHIP_SCHED_FALLING ? "FALLING" : "STABLE";
+}
+
+static int run(double budget) {
+    static ComchipIngest ingest;
+    static ComchipEngine engine;
+    static ComchipScheduler sched;
+    int masters[EXAMPLE_DEVICES];
+
+    if (comchip_engine_init(&engine, EXAMPLE_DEVICES, comchip_sched_on_response, NULL, &sched) < 0 ||
+        comchip_sched_init(&sched, &engine, budget, NULL, NULL) < 0 ||
+        comchip_ingest_init(&ingest, COMCHIP_INGEST_AUTO, EXAMPLE_DEVICES, comchip_engine_on_batch, NULL, &engine) < 0) {
+        perror("setup");
+        return -1;
+    }
+    sched.alarm_ns = 20 * COMCHIP_NS_PER_MS;
+    sched.falling_ns = 50 * COMCHIP_NS_PER_MS;
+    sched.base_ns = 100 * COMCHIP_NS_PER_MS;
+    sched.max_ns = 800 * COMCHIP_NS_PER_MS;
+
+    run_start = comchip_now_ns();
+    for (int i = 0; i < EXAMPLE_DEVICES; i++) {
+        int slave;
+        if (comchip_pty_open(&masters[i], &slave, COMCHIP_SERIAL_VMIN) < 0) {
+            perror("comchip_pty_open");
+            return -1;
+        }
+        fcntl(masters[i], F_SETFL, fcntl(masters[i], F_GETFL) | O_NONBLOCK);
+        int32_t dev = comchip_ingest_add(&ingest, slave, COMCHIP_STATUS_FRAME_LEN);
+        comchip_engine_attach(&engine, (uint32_t)dev, slave, 1);
+        comchip_sched_add(&sched, (uint32_t)dev);
+    }
+
+    uint64_t now = run_start;
+    while (now - run_start < EXAMPLE_RUN_NS) {
+        int timeout = comchip_engine_tick(&engine);
+        for (int i = 0; i < EXAMPLE_DEVICES; i++) {
+            sim_answer(masters[i], i, comchip_now_ns());
+        }
+        comchip_ingest_run_once(&ingest, timeout < 0 || timeout > 1 ? 1 : timeout); // The simulator shares this thread
+        now = comchip_now_ns();
+    }
+
+    if (budget == COMCHIP_SCHED_UNLIMITED) {
+        printf("Unlimited budget:\n");
+    } else {
+        printf("Budget %.0f polls/s:\n", budget);
+    }
+    printf("Dev | Class   | Interval (ms) | Polls | Trend (mV/s)\n");
+    uint64_t total = 0;
+    for (int i = 0; i < EXAMPLE_DEVICES; i++) {
+        const ComchipSchedDevice* d = &sched.devices[i];
+        printf("%3d | %-7s | %13.0f | %5llu | %7.0f\n", i, class_name(d->cls),
+               comchip_sched_effective_ns(&sched, d) / 1e6, (unsigned long long)d->polls, d->trend_mV_per_s);
+        total += d->polls;
+    }
+    printf("Total polls: %llu (%.0f/s); fixed polling at the alarm rate: %.0f\n\n",
+           (unsigned long long)total, total / (EXAMPLE_RUN_NS / 1e9),
+           EXAMPLE_DEVICES * (EXAMPLE_RUN_NS / (double)sched.alarm_ns));
+
+    comchip_sched_free(&sched);
+    comchip_ingest_close(&ingest);
+    comchip_engine_free(&engine);
+    for (int i = 0; i < EXAMPLE_DEVICES; i++) {
+        close(masters[i]);
+    }
+    return 0;
+}
+
+int main() {
+    if (run(COMCHIP_SCHED_UNLIMITED) < 0 || run(80) < 0) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+// Reading COMChip responses from serial ports. Pseudo-terminal pairs stand in
+// for the links: the example writes frames into the master ends, and the
+// slave ends are configured and drained exactly like real serial ports.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <poll.h>
+
+#include "comchip_frame.h"
+#include "comchip_serial.h"
+
+#define EXAMPLE_PORTS 3
+#define EXAMPLE_READ_BUDGET 1024
+
+static void print_status(void* ctx, const BatteryStatusData* data) {
+    printf("[port %d] Battery Voltage: %u mV | Under Voltage: %s\n",
+           *(const int*)ctx, data->battery_voltage_mV, data->is_under_voltage ? "YES" : "NO");
+}
+
+static bool readable(int fd) {
+    struct pollfd pfd = { fd, POLLIN, 0 };
+    return poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN);
+}
+
+int main() {
+    int masters[EXAMPLE_PORTS];
+    int ids[EXAMPLE_PORTS];
+    ComchipPort ports[EXAMPLE_PORTS];
+
+    for (int i = 0; i < EXAMPLE_PORTS; i++) {
+        int slave;
+        if (comchip_pty_open(&masters[i], &slave, COMCHIP_SERIAL_VMIN) < 0) {
+            perror("comchip_pty_open");
+            return 1;
+        }
+        ids[i] = i;
+        comchip_port_init(&ports[i], slave, print_status, &ids[i]);
+        comchip_stream_set_layout(&ports[i].stream, COMCHIP_STATUS_FRAME_LEN); // Older firmware on every link
+    }
+
+    // VMIN batching: half a frame does not make the port readable, the rest does
+    uint8_t frame[] = COMCHIP_FRAME(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE);
+    if (write(masters[0], frame, 3) != 3) {
+        perror("write");
+        return 1;
+    }
+    printf("Readable after 3 bytes: %s\n", readable(ports[0].fd) ? "YES" : "NO");
+    if (write(masters[0], frame + 3, sizeof(frame) - 3) != (ssize_t)(sizeof(frame) - 3)) {
+        perror("write");
+        return 1;
+    }
+    printf("Readable after 6 bytes: %s\n\n", readable(ports[0].fd) ? "YES" : "NO");
+
+    // A few responses on every port, then one pass over all readable ports
+    uint8_t burst[] = {
+        COMCHIP_FRAME_BYTES(COMCHIP_CID_GET_STATUS_RESP, 0x40, 0x96, 0xFE),
+        0x00, 0x13,
+        COMCHIP_FRAME_BYTES(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x6D, 0x60),
+    };
+    for (int i = 1; i < EXAMPLE_PORTS; i++) {
+        if (write(masters[i], burst, sizeof(burst)) != (ssize_t)sizeof(burst)) {
+            perror("write");
+            return 1;
+        }
+    }
+
+    for (int i = 0; i < EXAMPLE_PORTS; i++) {
+        if (!readable(ports[i].fd)) {
+            continue;
+        }
+        size_t n;
+        ComchipPortState state = comchip_port_drain(&ports[i], EXAMPLE_READ_BUDGET, &n);
+        printf("[port %d] %zu bytes, %s\n", i, n, state == COMCHIP_PORT_IDLE ? "drained" : "not drained");
+    }
+
+    // Closing the master end is a hang-up on the port
+    close(masters[0]);
+    printf("\n[port 0] After hang-up: %s\n",
+           comchip_port_drain(&ports[0], EXAMPLE_READ_BUDGET, NULL) == COMCHIP_PORT_CLOSED ? "closed" : "open");
+
+    printf("\n");
+    for (int i = 0; i < EXAMPLE_PORTS; i++) {
+        printf("[port %d] Reads: %llu | Bytes: %llu | Frames: %llu\n", i,
+               (unsigned long long)ports[i].reads, (unsigned long long)ports[i].bytes_read,
+               (unsigned long long)ports[i].stream.frames_ok);
+        close(ports[i].fd);
+        if (i > 0) {
+            close(masters[i]);
+        }
+    }
+    return 0;
+}
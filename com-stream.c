@@ -0,0 +1,83 @@
+// Streaming decode of noisy COMChip byte streams delivered in odd-sized chunks.
+// Port A runs older firmware (6-byte frames), port B newer firmware (7-byte
+// frames with Byte2); each port's decoder detects its layout on its own.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "comchip_frame.h"
+#include "comchip_stream.h"
+
+static void print_status(void* ctx, const BatteryStatusData* data) {
+    printf("[%s] Battery Voltage: %u mV | Error: %s | Under Voltage: %s | Supported: %s",
+           (const char*)ctx,
+           data->battery_voltage_mV,
+           data->has_battery_error ? "YES" : "NO",
+           data->is_under_voltage ? "YES" : "NO",
+           data->is_battery_supported ? "YES" : "NO");
+    if (data->has_discharge_status) {
+        printf(" | Discharge: 0x%02X", data->discharge_status);
+    }
+    printf("\n");
+}
+
+// Deliver the bytes the way read() would: in uneven chunks that split frames
+static void feed_in_chunks(ComchipStream* decoder, const uint8_t* stream, size_t total) {
+    static const size_t chunk_sizes[] = {2, 5, 1, 7, 3, 4, 8};
+    size_t offset = 0;
+
+    for (size_t c = 0; offset < total; c++) {
+        size_t len = chunk_sizes[c % (sizeof(chunk_sizes) / sizeof(chunk_sizes[0]))];
+        if (offset + len > total) {
+            len = total - offset;
+        }
+        comchip_stream_feed(decoder, &stream[offset], len);
+        offset += len;
+    }
+    comchip_stream_flush(decoder);
+}
+
+static void print_counters(const char* name, const ComchipStream* decoder) {
+    printf("[%s] Layout: %u-byte frames\n", name, decoder->layout_len);
+    printf("[%s] Frames decoded: %llu\n", name, (unsigned long long)decoder->frames_ok);
+    printf("[%s] Bytes skipped: %llu\n", name, (unsigned long long)decoder->bytes_skipped);
+    printf("[%s] CID mismatches: %llu\n", name, (unsigned long long)decoder->cid_mismatches);
+    printf("[%s] Checksum mismatches: %llu\n\n", name, (unsigned long long)decoder->checksum_mismatches);
+}
+
+int main() {
+    // Junk | good frame | noise with a stray SYNC | under voltage frame | bad checksum | good frames
+    uint8_t port_a[] = {
+        0x00, 0xFF, 0x13,
+        COMCHIP_FRAME_BYTES(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE),
+        0x55, 0x12, 0x55,
+        COMCHIP_FRAME_BYTES(COMCHIP_CID_GET_STATUS_RESP, 0x40, 0x96, 0xFE),
+        0x55, 0x81, 0x00, 0x96, 0xFE, 0x11,
+        COMCHIP_FRAME_BYTES(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE),
+        COMCHIP_FRAME_BYTES(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE),
+    };
+
+    // Same traffic from newer firmware: Byte2 = 0x01 before the checksum
+    uint8_t port_b[] = {
+        0x13, 0x55,
+        COMCHIP_FRAME_BYTES(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE, 0x01),
+        COMCHIP_FRAME_BYTES(COMCHIP_CID_GET_STATUS_RESP, 0x40, 0x96, 0xFE, 0x01),
+        0x00,
+        COMCHIP_FRAME_BYTES(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE, 0x01),
+        COMCHIP_FRAME_BYTES(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE, 0x01),
+    };
+
+    ComchipStream decoder_a;
+    ComchipStream decoder_b;
+    comchip_stream_init(&decoder_a, print_status, "A");
+    comchip_stream_init(&decoder_b, print_status, "B");
+
+    feed_in_chunks(&decoder_a, port_a, sizeof(port_a));
+    feed_in_chunks(&decoder_b, port_b, sizeof(port_b));
+
+    printf("\n");
+    print_counters("A", &decoder_a);
+    print_counters("B", &decoder_b);
+    return 0;
+}
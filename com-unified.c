@@ -0,0 +1,72 @@
+// One decoder for both 'Get Battery Status' frame generations (6-byte and 7-byte with Byte2)
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+
+#include "comchip_frame.h"
+#include "comchip_layout.h"
+#include "comchip_log.h"
+
+#define BENCH_ROUNDS 20000000u
+
+static void print_status(const BatteryStatusData* data) {
+    printf("Battery Voltage: %u mV\n", data->battery_voltage_mV);
+    printf("Battery Error: %s\n", data->has_battery_error ? "YES" : "NO");
+    printf("Under Voltage: %s\n", data->is_under_voltage ? "YES" : "NO");
+    printf("Battery Supported: %s\n", data->is_battery_supported ? "YES" : "NO");
+    if (data->has_discharge_status) {
+        printf("Discharge Status: 0x%02X\n", data->discharge_status);
+    }
+}
+
+int main() {
+    // SYNC | CID  | Status | Volt_H | Volt_L | [Byte2] | Checksum
+    uint8_t frame6[] = COMCHIP_FRAME(COMCHIP_CID_GET_STATUS_RESP, 0x00, 0x96, 0xFE);       // Older firmware
+    uint8_t frame7[] = COMCHIP_FRAME(COMCHIP_CID_GET_STATUS_RESP, 0x40, 0x96, 0xFE, 0x01); // Newer firmware, under voltage, Byte2 = 0x01
+
+    const uint8_t* frames[] = { frame6, frame7 };
+    uint16_t lengths[] = { sizeof(frame6), sizeof(frame7) };
+
+    ComchipLog log;
+    comchip_log_init(&log, stdout, 100, true);
+
+    for (size_t i = 0; i < 2; i++) {
+        BatteryStatusData status_data;
+        printf("--- Processing %u-byte Frame ---\n", lengths[i]);
+        ComchipResult result = comchip_parse_status_any(frames[i], lengths[i], &status_data);
+        comchip_log_result(&log, result);
+        comchip_log_flush(&log);
+        if (result.error == COMCHIP_OK) {
+            print_status(&status_data);
+        }
+        printf("\n");
+    }
+
+    // Per-frame cost of each specialized path
+    volatile uint16_t sink = 0;
+    BatteryStatusData status_data;
+    clock_t start = clock();
+    for (uint32_t r = 0; r < BENCH_ROUNDS; r++) {
+        __asm__ volatile("" ::: "memory"); // Keep the compiler from hoisting the parse
+        if (comchip_parse_status6(frame6, sizeof(frame6), &status_data).error == COMCHIP_OK) {
+            sink = status_data.battery_voltage_mV;
+        }
+    }
+    double t6 = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    start = clock();
+    for (uint32_t r = 0; r < BENCH_ROUNDS; r++) {
+        __asm__ volatile("" ::: "memory");
+        if (comchip_parse_status7(frame7, sizeof(frame7), &status_data).error == COMCHIP_OK) {
+            sink = status_data.battery_voltage_mV;
+        }
+    }
+    double t7 = (double)(clock() - start) / CLOCKS_PER_SEC;
+    (void)sink;
+
+    printf("6-byte path: %.2f ns/frame\n", t6 * 1e9 / BENCH_ROUNDS);
+    printf("7-byte path: %.2f ns/frame\n", t7 * 1e9 / BENCH_ROUNDS);
+    return 0;
+}
@@ -0,0 +1,63 @@
+// Cost of request deadlines at scale: 200k timers (one per outstanding
+// status poll) armed, mostly cancelled by their response, and the rest
+// expired, on a 1 ms timing wheel.
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "comchip_wheel.h"
+
+#define EXAMPLE_TIMERS 200000
+#define EXAMPLE_ROUNDS 10
+
+static uint64_t expired;
+
+static void on_deadline(void* ctx, ComchipTimer* t) {
+    (void)ctx;
+    (void)t;
+    expired++;
+}
+
+int main() {
+    static ComchipWheel wheel;
+    static ComchipTimer timers[EXAMPLE_TIMERS];
+    uint64_t clock_ns = 0; // Simulated time, so the run is repeatable
+
+    comchip_wheel_init(&wheel, COMCHIP_NS_PER_MS, clock_ns);
+    for (uint32_t i = 0; i < EXAMPLE_TIMERS; i++) {
+        comchip_timer_init(&timers[i], on_deadline, NULL);
+    }
+
+    uint64_t arms = 0, cancels = 0;
+    uint32_t seed = 1;
+    uint64_t start = comchip_now_ns();
+    for (int round = 0; round < EXAMPLE_ROUNDS; round++) {
+        // Every poll gets a 50-1000 ms deadline (beyond 256 ms they start in level 1)
+        for (uint32_t i = 0; i < EXAMPLE_TIMERS; i++) {
+            seed = seed * 1103515245u + 12345u;
+            comchip_timer_arm(&wheel, &timers[i], clock_ns + (50 + (seed >> 8) % 951) * COMCHIP_NS_PER_MS);
+            arms++;
+        }
+        // 95% of the responses arrive in time and cancel their deadline
+        for (uint32_t i = 0; i < EXAMPLE_TIMERS; i++) {
+            if (i % 20 != 0) {
+                comchip_timer_cancel(&wheel, &timers[i]);
+                cancels++;
+            }
+        }
+        // Let the rest expire, 1 ms at a time as an event loop would
+        for (int ms = 0; ms < 1001; ms++) {
+            clock_ns += COMCHIP_NS_PER_MS;
+            comchip_wheel_advance(&wheel, clock_ns);
+        }
+    }
+    double elapsed = (comchip_now_ns() - start) / 1e9;
+
+    printf("Arms: %llu | Cancels: %llu | Expired: %llu | Cascaded: %llu\n",
+           (unsigned long long)arms, (unsigned long long)cancels,
+           (unsigned long long)expired, (unsigned long long)wheel.cascaded);
+    printf("%.1f ns per timer operation\n", elapsed * 1e9 / (arms + cancels + expired));
+    return 0;
+}
@@ -0,0 +1,72 @@
+// --- COMChip Protocol: Shared Constants and Definitions ---
+// Header-only so every example program can still be built on its own:
+//     gcc -std=gnu11 -Wall com-stream.c -o com-stream
+
+#ifndef COMCHIP_H
+#define COMCHIP_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// SYNC byte, CIDs, field offsets and status bits are declared once in the schema
+#include "comchip_schema.h"
+
+// Expected frame length for the 'Get Battery Status' response without Byte2
+// SYNC (1) + CID (1) + Status Byte (1) + Voltage (2) + Checksum (1) = 6 bytes
+#define COMCHIP_STATUS_FRAME_LEN       COMCHIP_STATUS_RESP_FRAME_LEN
+
+// Newer firmware appends Byte2 (discharge status) before the checksum
+// SYNC (1) + CID (1) + Status Byte (1) + Voltage (2) + Byte2 (1) + Checksum (1) = 7 bytes
+#define COMCHIP_STATUS_FRAME_LEN_BYTE2 COMCHIP_STATUS_RESP7_FRAME_LEN
+
+// --- Checksum Calculation Function ---
+// This function is based on the ODM_com_checksum_calc routine from the document.
+// It calculates an 8-bit checksum for a given buffer of data.
+static inline uint8_t calculate_checksum(uint8_t cid, const uint8_t* data_buffer, uint8_t len) {
+    uint16_t tmp = cid;
+    uint8_t i;
+
+    for (i = 0; i < len; i++) {
+        tmp += data_buffer[i];
+        // The document's example uses tmp -= 255u; for overflow.
+        if (tmp >= 256u) {
+            tmp -= 255u;
+        }
+    }
+    tmp = (~tmp) & 0x00FFu; // Bitwise NOT and mask to 8 bits
+    return (uint8_t)tmp;
+}
+
+// --- Data Packet Structure (for easier access to parsed data) ---
+typedef struct {
+    uint16_t battery_voltage_mV;
+    bool     has_battery_error;
+    bool     is_under_voltage;
+    bool     is_battery_supported;
+    bool     has_discharge_status; // Byte2 present (7-byte frames only)
+    uint8_t  discharge_status;     // Byte2 (discharged/not discharged), 0 when absent
+} BatteryStatusData;
+
+// --- Decode an Already Validated Status Frame ---
+// `frame` points at the SYNC byte. Voltage is HIGH byte first (Big-Endian),
+// as in process_comchip_status_packet().
+// Status and voltage sit at the same offsets in both frame layouts.
+static inline void comchip_decode_status_frame(const uint8_t* frame, BatteryStatusData* out_data) {
+    out_data->battery_voltage_mV = (uint16_t)comchip_status_resp_voltage_mV(frame);
+    out_data->has_battery_error = comchip_status_resp_battery_error(frame);
+    out_data->is_under_voltage = comchip_status_resp_under_voltage(frame);
+    out_data->is_battery_supported = !comchip_status_resp_not_supported(frame); // If bit 5 is 1, it's NOT supported
+    out_data->has_discharge_status = false;
+    out_data->discharge_status = 0;
+}
+
+// --- Status Byte ---
+// The status byte as it came off the wire, rebuilt from the decoded flags
+static inline uint8_t comchip_status_byte(const BatteryStatusData* data) {
+    return (uint8_t)((data->has_battery_error ? STATUS_BIT_BATTERY_ERROR : 0) |
+                     (data->is_under_voltage ? STATUS_BIT_UNDER_VOLTAGE : 0) |
+                     (data->is_battery_supported ? 0 : STATUS_BIT_NOT_SUPPORTED));
+}
+
+#endif // COMCHIP_H
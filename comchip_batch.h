@@ -0,0 +1,66 @@
+// --- COMChip Batch Decoder (structure-of-arrays output) ---
+// Decodes a contiguous buffer of N fixed-size 'Get Battery Status' frames in
+// one call. Instead of one BatteryStatusData per frame, each field goes into
+// its own column: a voltage array plus one bit per frame in the error,
+// under-voltage, not-supported and validity bitmaps. Downstream aggregation
+// can then run over a single column (e.g. popcount of a bitmap).
+
+#ifndef COMCHIP_BATCH_H
+#define COMCHIP_BATCH_H
+
+#include "comchip.h"
+#include "comchip_checksum.h"
+
+// Number of 64-bit bitmap words needed for n frames
+#define COMCHIP_BITMAP_WORDS(n) (((n) + 63u) / 64u)
+
+// Caller-owned output columns, sized for at least n frames.
+// Bit i of word i / 64 belongs to frame i. Invalid frames get voltage 0 and
+// all flag bits clear, so columns can be aggregated without a separate mask.
+typedef struct {
+    uint16_t* voltage_mV;         // n entries
+    uint64_t* error_bits;         // Bit set = has battery error
+    uint64_t* under_voltage_bits; // Bit set = under voltage detected
+    uint64_t* not_supported_bits; // Bit set = battery not supported
+    uint64_t* valid_bits;         // Bit set = SYNC, CID and checksum all valid
+} BatteryStatusColumns;
+
+// --- Decode a Batch of Frames ---
+// Works in blocks of 64 frames so each block fills exactly one word of every
+// bitmap. Checksums for the block are verified by the dispatched kernel.
+// Returns the number of valid frames.
+static inline size_t comchip_decode_batch(const uint8_t* frames, size_t n, BatteryStatusColumns* out) {
+    uint8_t cs_ok[64];
+    size_t valid_total = 0;
+
+    for (size_t base = 0; base < n; base += 64) {
+        size_t count = n - base < 64 ? n - base : 64;
+        const uint8_t* block = frames + base * COMCHIP_STATUS_FRAME_LEN;
+        uint64_t valid = 0, error = 0, under = 0, unsupported = 0;
+
+        comchip_checksum_verify_frames(block, count, COMCHIP_STATUS_FRAME_LEN, cs_ok);
+
+        for (size_t i = 0; i < count; i++) {
+            const uint8_t* f = block + i * COMCHIP_STATUS_FRAME_LEN;
+            uint64_t ok = (uint64_t)(cs_ok[i] & (f[COMCHIP_SYNC_INDEX] == COMCHIP_SYNC_BYTE) &
+                                     (f[COMCHIP_CID_INDEX] == COMCHIP_STATUS_RESP_CID));
+            uint64_t keep = 0 - ok; // All ones for a valid frame, zero otherwise
+
+            out->voltage_mV[base + i] = (uint16_t)(comchip_status_resp_voltage_mV(f) & keep);
+            valid |= ok << i;
+            error |= (uint64_t)comchip_status_resp_battery_error(f) << i;
+            under |= (uint64_t)comchip_status_resp_under_voltage(f) << i;
+            unsupported |= (uint64_t)comchip_status_resp_not_supported(f) << i;
+        }
+
+        size_t word = base / 64;
+        out->valid_bits[word] = valid;
+        out->error_bits[word] = error & valid;
+        out->under_voltage_bits[word] = under & valid;
+        out->not_supported_bits[word] = unsupported & valid;
+        valid_total += (size_t)__builtin_popcountll(valid);
+    }
+    return valid_total;
+}
+
+#endif // COMCHIP_BATCH_H
@@ -0,0 +1,374 @@
+// --- COMChip RS-485 Multi-Drop Bus Arbiter ---
+// Polls several COMChips that share one half-duplex bus (one port, one fd).
+// On a shared bus every request starts with the address byte of the drop it
+// is meant for, and drops ignore requests that are not theirs:
+//     Address (1) | SYNC | CID | Checksum
+// Responses carry no address. They can only be told apart because the bus
+// allows one transaction at a time: the arbiter sends a request, and the
+// next response on that port belongs to the drop that was asked.
+//
+// Ordering: when a transaction ends (response or timeout), the next request
+// is written from the same callback, so the bus does not sit idle for an
+// event loop round. Drops take turns round-robin among those with polls
+// pending. A drop that misses its deadline is put into backoff (doubling per
+// consecutive miss) and skipped until it ends, so a dead drop costs one
+// timeout per backoff instead of one per turn. The deadline is the wire time
+// of request and response at the bus baud rate plus a turnaround allowance;
+// it must cover the slowest drop, as a response arriving after the next
+// request went out would be taken for the next drop's.
+//
+// Every bus reports how its time was used: busy (request sent until response
+// received), lost to timeouts, gaps (a request was ready but not yet sent)
+// and the bits actually on the wire.
+//
+// Wiring, as with the request engine: register comchip_bus_on_batch() as the
+// ingestion backend's batch callback with the arbiter as its context, attach
+// each bus port's fd, and call comchip_bus_tick() around every run_once().
+
+#ifndef COMCHIP_BUS_H
+#define COMCHIP_BUS_H
+
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "comchip_engine.h" // COMCHIP_POLL_CONTINUOUS, and the same event/frame/wheel headers
+
+#define COMCHIP_BUS_MAX_DROPS     32
+#define COMCHIP_BUS_NO_DROP       0xFF
+#define COMCHIP_BUS_REQ_LEN       (1 + COMCHIP_STATUS_REQ_FRAME_LEN) // Address + request
+#define COMCHIP_BUS_TURNAROUND_NS (5 * COMCHIP_NS_PER_MS)   // Allowed for a drop to start answering
+#define COMCHIP_BUS_BACKOFF_NS    (20 * COMCHIP_NS_PER_MS)  // First skip after a miss, doubled per miss
+#define COMCHIP_BUS_BACKOFF_MAX   (2000 * COMCHIP_NS_PER_MS)
+#define COMCHIP_BUS_MAX_RETRIES   3                         // Misses before a poll is given up
+#define COMCHIP_BUS_TICK_NS       COMCHIP_NS_PER_MS
+
+typedef struct {
+    uint8_t  addr;
+    uint32_t pending;        // Polls not sent yet (COMCHIP_POLL_CONTINUOUS: forever)
+    uint8_t  misses;         // Consecutive timeouts
+    uint64_t not_before_ns;  // Backoff: skipped until then
+
+    uint64_t polls;
+    uint64_t responses;
+    uint64_t timeouts;
+    uint64_t failures;       // Polls given up after COMCHIP_BUS_MAX_RETRIES
+    uint64_t rtt_sum_ns;
+} ComchipDrop;
+
+typedef struct ComchipBusArbiter ComchipBusArbiter;
+
+typedef struct {
+    ComchipBusArbiter* arbiter;
+    uint32_t    id;           // Port id of the bus
+    int         fd;           // -1 = not attached
+    uint32_t    baud;
+    uint64_t    deadline_ns;  // Per transaction: wire time + turnaround
+    ComchipDrop drops[COMCHIP_BUS_MAX_DROPS];
+    uint8_t     drop_count;
+    uint8_t     slot_of[256]; // Address -> drop index, COMCHIP_BUS_NO_DROP if none
+    uint8_t     cursor;       // Drop that went last
+    uint8_t     current;      // Drop being asked, COMCHIP_BUS_NO_DROP when the bus is free
+    uint64_t    started_ns;   // Current transaction's request time
+    uint64_t    ready_ns;     // When a request became ready while the bus was free (0 = none)
+    ComchipTimer timer;       // Deadline, end of a backoff, or a retried write
+
+    // Utilization, since attach
+    uint64_t since_ns;
+    uint64_t busy_ns;        // Transactions that got a response
+    uint64_t timeout_ns;     // Transactions that timed out
+    uint64_t gap_ns;         // Ready to send but not sending
+    uint64_t wire_bytes;     // Request and response bytes
+    uint64_t transactions;
+    uint64_t unmatched;      // Responses while the bus was free
+} ComchipBus;
+
+typedef void (*comchip_bus_response_cb)(void* ctx, uint32_t bus, uint8_t addr, const BatteryStatusData* data,
+                                        uint64_t rtt_ns);
+typedef void (*comchip_bus_failure_cb)(void* ctx, uint32_t bus, uint8_t addr);
+
+struct ComchipBusArbiter {
+    ComchipBus*  buses;      // Indexed by port id
+    uint32_t     buses_cap;
+    ComchipWheel wheel;
+
+    comchip_bus_response_cb on_response;
+    comchip_bus_failure_cb  on_failure; // May be NULL
+    void*                   ctx;
+
+    uint64_t turnaround_ns;
+    uint64_t backoff_ns;
+    uint64_t backoff_max_ns;
+    uint8_t  max_retries;
+};
+
+// Time `bytes` take on the wire at `baud` (8N1: 10 bits per byte)
+static inline uint64_t comchip_bus_wire_ns(uint32_t baud, size_t bytes) {
+    return (uint64_t)bytes * 10 * COMCHIP_NS_PER_S / baud;
+}
+
+// --- Setup ---
+// buses_cap matches the ingestion backend's ports_cap. Returns 0, or -1 with errno set.
+static inline int comchip_bus_init(ComchipBusArbiter* a, uint32_t buses_cap, comchip_bus_response_cb on_response,
+                                   comchip_bus_failure_cb on_failure, void* ctx) {
+    memset(a, 0, sizeof(*a));
+    a->buses = (ComchipBus*)calloc(buses_cap, sizeof(*a->buses));
+    if (!a->buses) {
+        errno = ENOMEM;
+        return -1;
+    }
+    for (uint32_t i = 0; i < buses_cap; i++) {
+        a->buses[i].fd = -1;
+    }
+    a->buses_cap = buses_cap;
+    comchip_wheel_init(&a->wheel, COMCHIP_BUS_TICK_NS, comchip_now_ns());
+    a->on_response = on_response;
+    a->on_failure = on_failure;
+    a->ctx = ctx;
+    a->turnaround_ns = COMCHIP_BUS_TURNAROUND_NS;
+    a->backoff_ns = COMCHIP_BUS_BACKOFF_NS;
+    a->backoff_max_ns = COMCHIP_BUS_BACKOFF_MAX;
+    a->max_retries = COMCHIP_BUS_MAX_RETRIES;
+    return 0;
+}
+
+static inline void comchip_bus_free(ComchipBusArbiter* a) {
+    free(a->buses);
+    memset(a, 0, sizeof(*a));
+}
+
+static void comchip_bus_on_timer(void* ctx, ComchipTimer* t);
+
+// Start arbitrating the bus on port `bus`. fd is the port's fd, still owned
+// by the ingestion backend; requests are written to it. The deadline uses
+// the arbiter's turnaround_ns as set at this point. fd is made non-blocking
+// (if it is not already), so a full output queue never stalls the loop
+// whichever backend reads from the port.
+static inline bool comchip_bus_attach(ComchipBusArbiter* a, uint32_t bus, int fd, uint32_t baud) {
+    if (bus >= a->buses_cap || baud == 0) {
+        return false;
+    }
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || (!(flags & O_NONBLOCK) && fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)) {
+        return false;
+    }
+    ComchipBus* b = &a->buses[bus];
+    comchip_timer_cancel(&a->wheel, &b->timer);
+    memset(b, 0, sizeof(*b));
+    memset(b->slot_of, COMCHIP_BUS_NO_DROP, sizeof(b->slot_of));
+    b->arbiter = a;
+    b->id = bus;
+    b->fd = fd;
+    b->baud = baud;
+    b->deadline_ns = comchip_bus_wire_ns(baud, COMCHIP_BUS_REQ_LEN + COMCHIP_STATUS_RESP7_FRAME_LEN) +
+                     a->turnaround_ns;
+    b->current = COMCHIP_BUS_NO_DROP;
+    b->since_ns = comchip_now_ns();
+    comchip_timer_init(&b->timer, comchip_bus_on_timer, b);
+    return true;
+}
+
+static inline void comchip_bus_detach(ComchipBusArbiter* a, uint32_t bus) {
+    if (bus >= a->buses_cap) {
+        return;
+    }
+    ComchipBus* b = &a->buses[bus];
+    comchip_timer_cancel(&a->wheel, &b->timer);
+    b->fd = -1;
+}
+
+// Put a COMChip address on an attached bus. False if the bus id is out of
+// range, the bus is not attached (drops are reset by comchip_bus_attach()),
+// the address is already there or the bus is full.
+static inline bool comchip_bus_add_drop(ComchipBusArbiter* a, uint32_t bus, uint8_t addr) {
+    if (bus >= a->buses_cap || a->buses[bus].fd < 0) {
+        return false;
+    }
+    ComchipBus* b = &a->buses[bus];
+    if (b->slot_of[addr] != COMCHIP_BUS_NO_DROP || b->drop_count == COMCHIP_BUS_MAX_DROPS) {
+        return false;
+    }
+    ComchipDrop* d = &b->drops[b->drop_count];
+    memset(d, 0, sizeof(*d));
+    d->addr = addr;
+    b->slot_of[addr] = b->drop_count++;
+    return true;
+}
+
+// --- Arbitration ---
+// Next drop after the cursor with a poll pending and no backoff running, or
+// COMCHIP_BUS_NO_DROP. *wake gets the earliest backoff end among the others.
+static inline uint8_t comchip_bus_pick(const ComchipBus* b, uint64_t now, uint64_t* wake) {
+    *wake = UINT64_MAX;
+    for (uint8_t k = 1; k <= b->drop_count; k++) {
+        uint8_t i = (uint8_t)((b->cursor + k) % b->drop_count);
+        const ComchipDrop* d = &b->drops[i];
+        if (d->pending == 0) {
+            continue;
+        }
+        if (d->not_before_ns <= now) {
+            return i;
+        }
+        if (d->not_before_ns < *wake) {
+            *wake = d->not_before_ns;
+        }
+    }
+    return COMCHIP_BUS_NO_DROP;
+}
+
+// Start the next transaction if the bus is free, and point the timer at what
+// the bus waits for next
+static inline void comchip_bus_next(ComchipBusArbiter* a, ComchipBus* b, uint64_t now) {
+    if (b->current != COMCHIP_BUS_NO_DROP) {
+        return;
+    }
+    uint64_t wake;
+    uint8_t i = comchip_bus_pick(b, now, &wake);
+    if (i == COMCHIP_BUS_NO_DROP) {
+        b->ready_ns = 0;
+        if (wake == UINT64_MAX) {
+            comchip_timer_cancel(&a->wheel, &b->timer);
+        } else {
+            comchip_timer_arm(&a->wheel, &b->timer, wake);
+        }
+        return;
+    }
+    if (b->ready_ns == 0) {
+        b->ready_ns = now;
+    }
+
+    ComchipDrop* d = &b->drops[i];
+    uint8_t tx[COMCHIP_BUS_REQ_LEN];
+    tx[0] = d->addr;
+    memcpy(tx + 1, comchip_get_status_request, COMCHIP_STATUS_REQ_FRAME_LEN);
+    if (write(b->fd, tx, sizeof(tx)) != (ssize_t)sizeof(tx)) { // Non-blocking, see comchip_bus_attach()
+        // Output queue full (EAGAIN) or port gone; a partial request is left for the
+        // drops to discard by its checksum. Try again on the next tick.
+        comchip_timer_arm(&a->wheel, &b->timer, now + a->wheel.tick_ns);
+        return;
+    }
+
+    b->gap_ns += now - b->ready_ns;
+    b->ready_ns = 0;
+    b->cursor = i;
+    b->current = i;
+    b->started_ns = now;
+    b->transactions++;
+    b->wire_bytes += sizeof(tx);
+    d->polls++;
+    if (d->pending != COMCHIP_POLL_CONTINUOUS) {
+        d->pending--;
+    }
+    comchip_timer_arm(&a->wheel, &b->timer, now + b->deadline_ns);
+}
+
+// Queue `count` status polls for one drop (COMCHIP_POLL_CONTINUOUS: keep
+// polling). Goes out right away if the bus is free. False if the bus is not
+// attached or the address is not on it.
+static inline bool comchip_bus_poll(ComchipBusArbiter* a, uint32_t bus, uint8_t addr, uint32_t count) {
+    if (bus >= a->buses_cap) {
+        return false;
+    }
+    ComchipBus* b = &a->buses[bus];
+    uint8_t i = b->slot_of[addr];
+    if (b->fd < 0 || i == COMCHIP_BUS_NO_DROP) {
+        return false;
+    }
+    ComchipDrop* d = &b->drops[i];
+    if (count == COMCHIP_POLL_CONTINUOUS || d->pending > COMCHIP_POLL_CONTINUOUS - 1 - count) {
+        d->pending = COMCHIP_POLL_CONTINUOUS;
+    } else {
+        d->pending += count;
+    }
+    comchip_bus_next(a, b, comchip_now_ns());
+    return true;
+}
+
+// --- Timers ---
+// The current drop missed its deadline, a backoff ended, or a write is retried
+static void comchip_bus_on_timer(void* ctx, ComchipTimer* t) {
+    ComchipBus* b = (ComchipBus*)ctx;
+    ComchipBusArbiter* a = b->arbiter;
+    uint64_t now = comchip_now_ns();
+    (void)t;
+
+    if (b->current != COMCHIP_BUS_NO_DROP && now >= b->started_ns + b->deadline_ns) {
+        ComchipDrop* d = &b->drops[b->current];
+        b->current = COMCHIP_BUS_NO_DROP;
+        b->timeout_ns += now - b->started_ns;
+        d->timeouts++;
+        if (++d->misses > a->max_retries) {
+            d->failures++;
+            d->misses = 0;
+            if (a->on_failure) {
+                a->on_failure(a->ctx, b->id, d->addr);
+            }
+        } else if (d->pending != COMCHIP_POLL_CONTINUOUS) {
+            d->pending++; // Asked again after the backoff
+        }
+        uint64_t backoff = d->misses ? a->backoff_ns << (d->misses - 1) : 0;
+        d->not_before_ns = now + (backoff < a->backoff_max_ns ? backoff : a->backoff_max_ns);
+    }
+    if (b->fd >= 0) {
+        comchip_bus_next(a, b, now);
+    }
+}
+
+// --- Responses ---
+// Batch callback for the ingestion backend; ctx is the arbiter
+static inline void comchip_bus_on_batch(void* ctx, const ComchipStatusEvent* events, size_t n) {
+    ComchipBusArbiter* a = (ComchipBusArbiter*)ctx;
+    uint64_t now = comchip_now_ns();
+
+    for (size_t i = 0; i < n; i++) {
+        if (events[i].port >= a->buses_cap) {
+            continue;
+        }
+        ComchipBus* b = &a->buses[events[i].port];
+        if (b->fd < 0) {
+            continue;
+        }
+        b->wire_bytes += events[i].data.has_discharge_status ? COMCHIP_STATUS_RESP7_FRAME_LEN
+                                                             : COMCHIP_STATUS_FRAME_LEN;
+        if (b->current == COMCHIP_BUS_NO_DROP) {
+            b->unmatched++;
+            continue;
+        }
+
+        ComchipDrop* d = &b->drops[b->current];
+        uint64_t rtt = now - b->started_ns;
+        b->current = COMCHIP_BUS_NO_DROP;
+        b->busy_ns += rtt;
+        d->misses = 0;
+        d->responses++;
+        d->rtt_sum_ns += rtt;
+        a->on_response(a->ctx, b->id, d->addr, &events[i].data, rtt);
+
+        // Hand the bus to the next drop before anything else runs
+        if (b->fd >= 0) {
+            comchip_bus_next(a, b, now);
+        }
+    }
+}
+
+// --- Utilization ---
+// Share of the time since attach the bus spent in transactions, and the
+// share its baud rate was actually carrying bits
+static inline double comchip_bus_utilization(const ComchipBus* b, uint64_t now) {
+    return now > b->since_ns ? (double)(b->busy_ns + b->timeout_ns) / (now - b->since_ns) : 0.0;
+}
+
+static inline double comchip_bus_wire_utilization(const ComchipBus* b, uint64_t now) {
+    return now > b->since_ns ? (double)comchip_bus_wire_ns(b->baud, b->wire_bytes) / (now - b->since_ns) : 0.0;
+}
+
+// --- Event Loop ---
+// Run expired deadline, backoff and retry timers. Returns the timeout in
+// milliseconds for the next run_once() (-1 when no timer is armed).
+static inline int comchip_bus_tick(ComchipBusArbiter* a) {
+    comchip_wheel_advance(&a->wheel, comchip_now_ns());
+    return comchip_wheel_timeout_ms(&a->wheel, comchip_now_ns());
+}
+
+#endif // COMCHIP_BUS_H
@@ -0,0 +1,173 @@
+// --- COMChip Status Cache ---
+// Last decoded status of every battery, with a time to live, in front of the
+// request engine. A read within the TTL is answered from memory and never
+// touches the bus. A read that misses queues the caller and polls the
+// battery, unless a poll for it is already outstanding: then the caller just
+// joins the queue, so any number of readers asking for the same battery at
+// once cost one bus transaction. When the response arrives, the cache is
+// updated and every queued reader is called back with it.
+//
+// Readers queue with a ComchipCacheRead they own (intrusive, like the wheel's
+// timers), so nothing is allocated per read. Responses the engine got for
+// other reasons (e.g. the adaptive scheduler's polls) refresh the cache too
+// when the cache sits in the response chain.
+//
+// Wiring: initialise the engine with comchip_cache_on_response() and
+// comchip_cache_on_failure() and the cache as their context; the cache
+// forwards both to its own callbacks.
+
+#ifndef COMCHIP_CACHE_H
+#define COMCHIP_CACHE_H
+
+#include "comchip_engine.h"
+
+#define COMCHIP_CACHE_TTL_NS (100 * COMCHIP_NS_PER_MS)
+
+typedef struct ComchipCacheRead ComchipCacheRead;
+
+// data is NULL when the poll was given up
+typedef void (*comchip_cache_cb)(void* ctx, uint32_t dev, const BatteryStatusData* data);
+
+struct ComchipCacheRead {
+    ComchipCacheRead* next;
+    comchip_cache_cb  fn;
+    void*             ctx;
+};
+
+typedef struct {
+    BatteryStatusData data;
+    uint64_t          updated_ns; // 0 = never
+    bool              polling;    // A cache poll is outstanding
+    ComchipCacheRead* readers;    // Waiting for it, in arrival order
+    ComchipCacheRead* readers_tail;
+} ComchipCacheEntry;
+
+typedef struct {
+    ComchipEngine*     engine;
+    ComchipCacheEntry* entries; // Indexed by port id
+    uint32_t           entries_cap;
+    uint64_t           ttl_ns;
+
+    comchip_response_cb on_response; // Forwarded, may be NULL
+    comchip_failure_cb  on_failure;  // Forwarded, may be NULL
+    void*               ctx;
+
+    uint64_t hits;      // Answered from memory
+    uint64_t polls;     // Misses that went to the bus
+    uint64_t coalesced; // Misses that joined an outstanding poll
+} ComchipStatusCache;
+
+// Returns 0, or -1 with errno set
+static inline int comchip_cache_init(ComchipStatusCache* c, ComchipEngine* engine, uint64_t ttl_ns,
+                                     comchip_response_cb on_response, comchip_failure_cb on_failure, void* ctx) {
+    memset(c, 0, sizeof(*c));
+    c->entries = (ComchipCacheEntry*)calloc(engine->devices_cap, sizeof(*c->entries));
+    if (!c->entries) {
+        errno = ENOMEM;
+        return -1;
+    }
+    c->engine = engine;
+    c->entries_cap = engine->devices_cap;
+    c->ttl_ns = ttl_ns;
+    c->on_response = on_response;
+    c->on_failure = on_failure;
+    c->ctx = ctx;
+    return 0;
+}
+
+static inline void comchip_cache_free(ComchipStatusCache* c) {
+    free(c->entries);
+    memset(c, 0, sizeof(*c));
+}
+
+// --- Reads ---
+// Cached status of `dev` if it is at most max_age_ns old, else NULL. Never polls.
+static inline const BatteryStatusData* comchip_cache_peek(const ComchipStatusCache* c, uint32_t dev,
+                                                          uint64_t max_age_ns) {
+    if (dev >= c->entries_cap) {
+        return NULL;
+    }
+    const ComchipCacheEntry* en = &c->entries[dev];
+    if (en->updated_ns == 0 || comchip_now_ns() - en->updated_ns > max_age_ns) {
+        return NULL;
+    }
+    return &en->data;
+}
+
+// Call back and release everyone queued on `en`. Readers may queue again
+// from their callback; they land on the fresh list.
+static inline void comchip_cache_release(ComchipCacheEntry* en, uint32_t dev, const BatteryStatusData* data) {
+    ComchipCacheRead* r = en->readers;
+    en->readers = NULL;
+    en->readers_tail = NULL;
+    en->polling = false;
+    while (r) {
+        ComchipCacheRead* next = r->next;
+        r->fn(r->ctx, dev, data);
+        r = next;
+    }
+}
+
+// Status of `dev` within the TTL. Returns it straight away on a hit (read
+// is not used); on a miss returns NULL and calls read->fn once the poll
+// answers or is given up. read must stay valid until then. When no poll can
+// be sent (no device attached on `dev`), read->fn gets NULL before this
+// returns.
+static inline const BatteryStatusData* comchip_cache_get(ComchipStatusCache* c, uint32_t dev,
+                                                         ComchipCacheRead* read) {
+    if (dev >= c->entries_cap) {
+        read->fn(read->ctx, dev, NULL);
+        return NULL;
+    }
+    const BatteryStatusData* hit = comchip_cache_peek(c, dev, c->ttl_ns);
+    if (hit) {
+        c->hits++;
+        return hit;
+    }
+
+    ComchipCacheEntry* en = &c->entries[dev];
+    read->next = NULL;
+    if (en->readers_tail) {
+        en->readers_tail->next = read;
+    } else {
+        en->readers = read;
+    }
+    en->readers_tail = read;
+
+    if (en->polling) {
+        c->coalesced++;
+    } else if (comchip_engine_poll(c->engine, dev, 1)) {
+        en->polling = true;
+        c->polls++;
+    } else {
+        comchip_cache_release(en, dev, NULL); // Given up on the spot
+    }
+    return NULL;
+}
+
+// --- Engine Callbacks ---
+// ctx is the cache
+static inline void comchip_cache_on_response(void* ctx, uint32_t dev, const BatteryStatusData* data, uint64_t rtt_ns) {
+    ComchipStatusCache* c = (ComchipStatusCache*)ctx;
+    if (dev < c->entries_cap) {
+        ComchipCacheEntry* en = &c->entries[dev];
+        en->data = *data;
+        en->updated_ns = comchip_now_ns();
+        comchip_cache_release(en, dev, &en->data);
+    }
+    if (c->on_response) {
+        c->on_response(c->ctx, dev, data, rtt_ns);
+    }
+}
+
+static inline void comchip_cache_on_failure(void* ctx, uint32_t dev) {
+    ComchipStatusCache* c = (ComchipStatusCache*)ctx;
+    if (dev < c->entries_cap) {
+        comchip_cache_release(&c->entries[dev], dev, NULL);
+    }
+    if (c->on_failure) {
+        c->on_failure(c->ctx, dev);
+    }
+}
+
+#endif // COMCHIP_CACHE_H
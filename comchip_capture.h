@@ -0,0 +1,338 @@
+// --- COMChip Capture File ---
+// Append-only recording of raw link traffic, for forensics and for replaying
+// real captures through the decoders. One chunk per read() of a port, so a
+// capture keeps exactly what arrived, when and where:
+//     Header  (64)   magic "COMCAP", version, start time
+//     Chunk   (16)   magic, port, length, timestamp   + raw bytes, padded to 8
+//     Chunk   ...
+//     Index          one entry per chunk: offset, timestamp
+//     Trailer (32)   magic "COMCAPIX", index offset, chunk count, end time
+// Timestamps are CLOCK_MONOTONIC nanoseconds (comchip_now_ns()) and never go
+// backwards within a file: an earlier one is raised to the last one written.
+// All fields are little-endian, as the reader maps the file straight onto
+// these structs.
+//
+// The writer copies chunks into a page-aligned block buffer and only ever
+// write()s whole blocks at block-aligned offsets, except for the final tail
+// on close, so the kernel sees few, large, aligned writes however small the
+// chunks are. The index is kept in memory and appended on close. A file cut
+// short by a crash has no trailer; the reader then walks the chunks from the
+// start and stops at the first incomplete one.
+//
+// The reader mmap()s the whole file read-only; chunk data is handed out as
+// pointers into the mapping, so decoders walk it without a copy.
+
+#ifndef COMCHIP_CAPTURE_H
+#define COMCHIP_CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+_Static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Capture files are mapped as little-endian structs");
+
+#define COMCHIP_CAPTURE_MAGIC         "COMCAP\0\0"
+#define COMCHIP_CAPTURE_INDEX_MAGIC   "COMCAPIX"
+#define COMCHIP_CAPTURE_CHUNK_MAGIC   0x4B43u     // "CK"
+#define COMCHIP_CAPTURE_VERSION       1
+#define COMCHIP_CAPTURE_ALIGN         8           // Chunk alignment in the file
+#define COMCHIP_CAPTURE_BLOCK         (256 * 1024) // Write unit
+#define COMCHIP_CAPTURE_PAGE          4096
+
+typedef struct {
+    char     magic[8];
+    uint32_t version;
+    uint32_t header_len;   // Offset of the first chunk
+    uint64_t start_ns;
+    uint8_t  reserved[40];
+} ComchipCaptureHeader;
+
+typedef struct {
+    uint16_t magic;
+    uint16_t port;
+    uint32_t len;          // Raw bytes following the header
+    uint64_t timestamp_ns;
+} ComchipCaptureChunkHeader;
+
+typedef struct {
+    uint64_t offset;       // Of the chunk header
+    uint64_t timestamp_ns;
+} ComchipCaptureIndexEntry;
+
+typedef struct {
+    char     magic[8];
+    uint64_t index_offset;
+    uint64_t chunk_count;
+    uint64_t end_ns;       // Last timestamp
+} ComchipCaptureTrailer;
+
+_Static_assert(sizeof(ComchipCaptureHeader) == 64, "Capture header layout");
+_Static_assert(sizeof(ComchipCaptureChunkHeader) == 16, "Capture chunk header layout");
+_Static_assert(sizeof(ComchipCaptureIndexEntry) == 16, "Capture index entry layout");
+_Static_assert(sizeof(ComchipCaptureTrailer) == 32, "Capture trailer layout");
+
+static inline size_t comchip_capture_padded(size_t len) {
+    return (len + COMCHIP_CAPTURE_ALIGN - 1) & ~(size_t)(COMCHIP_CAPTURE_ALIGN - 1);
+}
+
+// --- Writer ---
+typedef struct {
+    int      fd;
+    uint8_t* block;       // COMCHIP_CAPTURE_BLOCK bytes, page-aligned
+    size_t   fill;
+    uint64_t flushed;     // Bytes already in the file
+    uint64_t start_ns;
+    uint64_t last_ns;
+
+    ComchipCaptureIndexEntry* index;
+    size_t                    index_len;
+    size_t                    index_cap;
+
+    uint64_t writes;      // write() calls
+} ComchipCaptureWriter;
+
+// Write the block buffer out. Returns 0, or -1 with errno set.
+static inline int comchip_capture_flush(ComchipCaptureWriter* w) {
+    size_t done = 0;
+    while (done < w->fill) {
+        ssize_t n = write(w->fd, w->block + done, w->fill - done);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        done += (size_t)n;
+        w->writes++;
+    }
+    w->flushed += w->fill;
+    w->fill = 0;
+    return 0;
+}
+
+// Copy bytes into the block buffer, writing every block that fills up
+static inline int comchip_capture_put(ComchipCaptureWriter* w, const void* src, size_t len) {
+    const uint8_t* p = (const uint8_t*)src;
+    while (len) {
+        size_t room = COMCHIP_CAPTURE_BLOCK - w->fill;
+        size_t n = len < room ? len : room;
+        memcpy(w->block + w->fill, p, n);
+        w->fill += n;
+        p += n;
+        len -= n;
+        if (w->fill == COMCHIP_CAPTURE_BLOCK && comchip_capture_flush(w) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Create (or truncate) a capture file. Returns 0, or -1 with errno set.
+static inline int comchip_capture_create(ComchipCaptureWriter* w, const char* path, uint64_t start_ns) {
+    memset(w, 0, sizeof(*w));
+    if (posix_memalign((void**)&w->block, COMCHIP_CAPTURE_PAGE, COMCHIP_CAPTURE_BLOCK) != 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    w->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (w->fd < 0) {
+        free(w->block);
+        return -1;
+    }
+    w->start_ns = start_ns;
+    w->last_ns = start_ns;
+
+    ComchipCaptureHeader h;
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, COMCHIP_CAPTURE_MAGIC, sizeof(h.magic));
+    h.version = COMCHIP_CAPTURE_VERSION;
+    h.header_len = sizeof(h);
+    h.start_ns = start_ns;
+    return comchip_capture_put(w, &h, sizeof(h));
+}
+
+// Record what one read() of `port` returned. Returns 0, or -1 with errno set.
+static inline int comchip_capture_append(ComchipCaptureWriter* w, uint16_t port, uint64_t timestamp_ns,
+                                         const uint8_t* data, uint32_t len) {
+    if (w->index_len == w->index_cap) {
+        size_t cap = w->index_cap ? w->index_cap * 2 : 4096;
+        ComchipCaptureIndexEntry* index = (ComchipCaptureIndexEntry*)realloc(w->index, cap * sizeof(*index));
+        if (!index) {
+            errno = ENOMEM;
+            return -1;
+        }
+        w->index = index;
+        w->index_cap = cap;
+    }
+    if (timestamp_ns < w->last_ns) {
+        timestamp_ns = w->last_ns;
+    }
+    w->last_ns = timestamp_ns;
+
+    ComchipCaptureIndexEntry* e = &w->index[w->index_len++];
+    e->offset = w->flushed + w->fill;
+    e->timestamp_ns = timestamp_ns;
+
+    static const uint8_t zeros[COMCHIP_CAPTURE_ALIGN];
+    ComchipCaptureChunkHeader h = { COMCHIP_CAPTURE_CHUNK_MAGIC, port, len, timestamp_ns };
+    if (comchip_capture_put(w, &h, sizeof(h)) < 0 || comchip_capture_put(w, data, len) < 0) {
+        return -1;
+    }
+    return comchip_capture_put(w, zeros, comchip_capture_padded(len) - len);
+}
+
+// Append the index and trailer and close the file. Returns 0, or -1 with
+// errno set (the file is closed either way).
+static inline int comchip_capture_close(ComchipCaptureWriter* w) {
+    ComchipCaptureTrailer t;
+    memcpy(t.magic, COMCHIP_CAPTURE_INDEX_MAGIC, sizeof(t.magic));
+    t.index_offset = w->flushed + w->fill;
+    t.chunk_count = w->index_len;
+    t.end_ns = w->last_ns;
+
+    int rc = 0;
+    if (comchip_capture_put(w, w->index, w->index_len * sizeof(*w->index)) < 0 ||
+        comchip_capture_put(w, &t, sizeof(t)) < 0 || comchip_capture_flush(w) < 0) {
+        rc = -1;
+    }
+    int saved = errno;
+    close(w->fd);
+    free(w->block);
+    free(w->index);
+    memset(w, 0, sizeof(*w));
+    errno = saved;
+    return rc;
+}
+
+// --- Reader ---
+typedef struct {
+    uint16_t       port;
+    uint64_t       timestamp_ns;
+    const uint8_t* data; // Into the mapping
+    uint32_t       len;
+} ComchipCaptureChunk;
+
+typedef struct {
+    const uint8_t*                  base;
+    size_t                          len;
+    const ComchipCaptureHeader*     header;
+    const ComchipCaptureIndexEntry* index;       // NULL without a trailer
+    uint64_t                        chunk_count; // From the trailer (0 without)
+    size_t                          data_end;    // End of the chunk area
+} ComchipCaptureReader;
+
+// Map a capture file. Returns 0, or -1 with errno set (EINVAL: not a capture).
+static inline int comchip_capture_map(ComchipCaptureReader* r, const char* path) {
+    memset(r, 0, sizeof(*r));
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return -1;
+    }
+    if ((size_t)st.st_size < sizeof(ComchipCaptureHeader)) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+    void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        return -1;
+    }
+    madvise(p, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+    r->base = (const uint8_t*)p;
+    r->len = (size_t)st.st_size;
+    r->header = (const ComchipCaptureHeader*)p;
+    if (memcmp(r->header->magic, COMCHIP_CAPTURE_MAGIC, sizeof(r->header->magic)) != 0 ||
+        r->header->version != COMCHIP_CAPTURE_VERSION || r->header->header_len > r->len) {
+        munmap(p, r->len);
+        memset(r, 0, sizeof(*r));
+        errno = EINVAL;
+        return -1;
+    }
+
+    r->data_end = r->len;
+    if (r->len >= r->header->header_len + sizeof(ComchipCaptureTrailer)) {
+        const ComchipCaptureTrailer* t = (const ComchipCaptureTrailer*)(r->base + r->len - sizeof(*t));
+        if (memcmp(t->magic, COMCHIP_CAPTURE_INDEX_MAGIC, sizeof(t->magic)) == 0 &&
+            t->index_offset >= r->header->header_len &&
+            t->index_offset <= r->len - sizeof(*t) &&
+            t->chunk_count == (r->len - sizeof(*t) - t->index_offset) / sizeof(ComchipCaptureIndexEntry)) {
+            r->index = (const ComchipCaptureIndexEntry*)(r->base + t->index_offset);
+            r->chunk_count = t->chunk_count;
+            r->data_end = t->index_offset;
+        }
+    }
+    return 0;
+}
+
+static inline void comchip_capture_unmap(ComchipCaptureReader* r) {
+    if (r->base) {
+        munmap((void*)r->base, r->len);
+    }
+    memset(r, 0, sizeof(*r));
+}
+
+// Offset of the first chunk, for comchip_capture_next()
+static inline size_t comchip_capture_begin(const ComchipCaptureReader* r) {
+    return r->header->header_len;
+}
+
+// Walk the chunks in file order. Returns false at the end or at the first
+// damaged or incomplete chunk. offset may come from the on-disk index, so it
+// is checked without trusting it to be sane.
+static inline bool comchip_capture_next(const ComchipCaptureReader* r, size_t* offset, ComchipCaptureChunk* out) {
+    size_t at = *offset;
+    if (at % 8 || at < r->header->header_len || at > r->data_end ||
+        r->data_end - at < sizeof(ComchipCaptureChunkHeader)) {
+        return false;
+    }
+    const ComchipCaptureChunkHeader* h = (const ComchipCaptureChunkHeader*)(r->base + at);
+    size_t body = comchip_capture_padded(h->len);
+    if (h->magic != COMCHIP_CAPTURE_CHUNK_MAGIC || body > r->data_end - at - sizeof(*h)) {
+        return false;
+    }
+    out->port = h->port;
+    out->timestamp_ns = h->timestamp_ns;
+    out->data = r->base + at + sizeof(*h);
+    out->len = h->len;
+    *offset = at + sizeof(*h) + body;
+    return true;
+}
+
+// Chunk i through the index (requires a trailer)
+static inline bool comchip_capture_chunk_at(const ComchipCaptureReader* r, uint64_t i, ComchipCaptureChunk* out) {
+    if (!r->index || i >= r->chunk_count) {
+        return false;
+    }
+    size_t offset = (size_t)r->index[i].offset;
+    return comchip_capture_next(r, &offset, out);
+}
+
+// First chunk at or after timestamp_ns, by binary search over the index
+// (chunk_count when there is none)
+static inline uint64_t comchip_capture_seek(const ComchipCaptureReader* r, uint64_t timestamp_ns) {
+    uint64_t lo = 0, hi = r->chunk_count;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (r->index[mid].timestamp_ns < timestamp_ns) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+#endif // COMCHIP_CAPTURE_H
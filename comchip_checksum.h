@@ -0,0 +1,302 @@
+// --- COMChip Checksum Kernels ---
+// The document's ODM_com_checksum_calc adds one byte at a time and folds with
+// `tmp -= 255u` whenever the total reaches 256. That fold keeps tmp congruent
+// to the plain byte sum S modulo 255, and tmp only becomes 0 when S itself is
+// 0 (otherwise it ends in 1..255). So the same result comes from summing all
+// bytes first and folding once at the end:
+//     while (S > 255) S = (S & 0xFF) + (S >> 8);   // 256 == 1 (mod 255)
+//     checksum = ~S & 0xFF
+// This lets the wide kernels below add 8/16/32 bytes per step and still be
+// bit-identical to calculate_checksum().
+//
+// Kernels: scalar (the document's loop), SWAR (64-bit words), SSE4.1, AVX2.
+// The best supported one is picked once on first use from CPUID.
+
+#ifndef COMCHIP_CHECKSUM_H
+#define COMCHIP_CHECKSUM_H
+
+#include <string.h>
+
+#include "comchip.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <immintrin.h>
+#define COMCHIP_CHECKSUM_X86 1
+#endif
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define COMCHIP_CHECKSUM_LE 1
+#endif
+
+typedef struct {
+    const char* name;
+    // Checksum of CID followed by len data bytes
+    uint8_t (*checksum)(uint8_t cid, const uint8_t* data, size_t len);
+    // Verify n frames of frame_len bytes stored back to back (SYNC, CID, data..., checksum).
+    // ok[i] is set to 1/0 per frame when ok is not NULL. Returns the number of valid frames.
+    size_t (*verify)(const uint8_t* frames, size_t n, size_t frame_len, uint8_t* ok);
+} ComchipChecksumKernel;
+
+// Fold a plain byte sum into the document's checksum
+static inline uint8_t comchip_checksum_fold(uint64_t sum) {
+    while (sum > 0xFFu) {
+        sum = (sum & 0xFFu) + (sum >> 8);
+    }
+    return (uint8_t)(~sum & 0xFFu);
+}
+
+// --- Scalar Kernel (the document's algorithm, byte at a time) ---
+static inline uint8_t comchip_checksum_scalar(uint8_t cid, const uint8_t* data, size_t len) {
+    uint16_t tmp = cid;
+
+    for (size_t i = 0; i < len; i++) {
+        tmp += data[i];
+        if (tmp >= 256u) {
+            tmp -= 255u;
+        }
+    }
+    return (uint8_t)(~tmp & 0x00FFu);
+}
+
+static inline size_t comchip_verify_scalar(const uint8_t* frames, size_t n, size_t frame_len, uint8_t* ok) {
+    size_t valid = 0;
+
+    for (size_t i = 0; i < n; i++) {
+        const uint8_t* f = frames + i * frame_len;
+        bool good = comchip_checksum_scalar(f[1], &f[2], frame_len - 3) == f[frame_len - 1];
+        if (ok) {
+            ok[i] = good;
+        }
+        valid += good;
+    }
+    return valid;
+}
+
+// --- SWAR Kernel (8 bytes per 64-bit word) ---
+#ifdef COMCHIP_CHECKSUM_LE
+// Horizontal sum of the 8 bytes in a word without a per-byte loop
+static inline uint64_t comchip_swar_hsum(uint64_t w) {
+    w = (w & 0x00FF00FF00FF00FFull) + ((w >> 8) & 0x00FF00FF00FF00FFull); // 4 x 16-bit lanes
+    return (w * 0x0001000100010001ull) >> 48;                            // Sum of the lanes
+}
+
+static inline uint8_t comchip_checksum_swar(uint8_t cid, const uint8_t* data, size_t len) {
+    uint64_t sum = cid;
+    size_t i = 0;
+
+    for (; i + 8 <= len; i += 8) {
+        uint64_t w;
+        memcpy(&w, data + i, 8);
+        sum += comchip_swar_hsum(w);
+    }
+    for (; i < len; i++) {
+        sum += data[i];
+    }
+    return comchip_checksum_fold(sum);
+}
+
+// Frames of up to 8 bytes are read as one word; the last frames of the buffer,
+// where an 8-byte read would run past the end, go through the scalar loop.
+static inline size_t comchip_verify_swar(const uint8_t* frames, size_t n, size_t frame_len, uint8_t* ok) {
+    if (frame_len > 8) {
+        return comchip_verify_scalar(frames, n, frame_len, ok);
+    }
+    const uint64_t data_mask = ((~0ull) >> (8 * (9 - frame_len))) & ~0xFFull; // Bytes 1 .. frame_len - 2
+    const unsigned cs_shift = 8u * (unsigned)(frame_len - 1);
+    size_t word_frames = n * frame_len >= 8 ? (n * frame_len - 8) / frame_len + 1 : 0;
+    size_t valid = 0;
+
+    for (size_t i = 0; i < word_frames; i++) {
+        uint64_t w;
+        memcpy(&w, frames + i * frame_len, 8);
+        uint8_t expected = comchip_checksum_fold(comchip_swar_hsum(w & data_mask));
+        bool good = expected == (uint8_t)(w >> cs_shift);
+        if (ok) {
+            ok[i] = good;
+        }
+        valid += good;
+    }
+    return valid + comchip_verify_scalar(frames + word_frames * frame_len, n - word_frames, frame_len,
+                                         ok ? ok + word_frames : NULL);
+}
+#endif // COMCHIP_CHECKSUM_LE
+
+#ifdef COMCHIP_CHECKSUM_X86
+// --- SSE4.1 Kernel ---
+// Buffers: 16 bytes per step with PSADBW. Frames: two 8-byte frame words per
+// vector, summed with PSADBW, folded and compared in 64-bit lanes.
+__attribute__((target("sse4.1")))
+static uint8_t comchip_checksum_sse41(uint8_t cid, const uint8_t* data, size_t len) {
+    __m128i acc = _mm_setzero_si128();
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+
+    for (; i + 16 <= len; i += 16) {
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i*)(data + i)), zero));
+    }
+    uint64_t sum = cid + (uint64_t)_mm_cvtsi128_si64(acc) + (uint64_t)_mm_extract_epi64(acc, 1);
+    for (; i < len; i++) {
+        sum += data[i];
+    }
+    return comchip_checksum_fold(sum);
+}
+
+// Fold two rounds in 64-bit lanes; enough for a sum of at most 8 bytes (< 2048)
+__attribute__((target("sse4.1")))
+static inline __m128i comchip_fold_epi64_sse(__m128i s) {
+    const __m128i low = _mm_set1_epi64x(0xFF);
+    s = _mm_add_epi64(_mm_and_si128(s, low), _mm_srli_epi64(s, 8));
+    s = _mm_add_epi64(_mm_and_si128(s, low), _mm_srli_epi64(s, 8));
+    return _mm_xor_si128(s, low); // ~S & 0xFF
+}
+
+__attribute__((target("sse4.1")))
+static size_t comchip_verify_sse41(const uint8_t* frames, size_t n, size_t frame_len, uint8_t* ok) {
+    if (frame_len > 8) {
+        return comchip_verify_scalar(frames, n, frame_len, ok);
+    }
+    const __m128i data_mask = _mm_set1_epi64x((long long)(((~0ull) >> (8 * (9 - frame_len))) & ~0xFFull));
+    const __m128i low = _mm_set1_epi64x(0xFF);
+    const __m128i zero = _mm_setzero_si128();
+    const int cs_shift = 8 * (int)(frame_len - 1);
+    size_t word_frames = n * frame_len >= 8 ? (n * frame_len - 8) / frame_len + 1 : 0;
+    size_t valid = 0;
+    size_t i = 0;
+
+    for (; i + 2 <= word_frames; i += 2) {
+        const uint8_t* f = frames + i * frame_len;
+        __m128i w = _mm_loadl_epi64((const __m128i*)f);
+        long long w1;
+        memcpy(&w1, f + frame_len, 8);
+        w = _mm_insert_epi64(w, w1, 1);
+
+        __m128i expected = comchip_fold_epi64_sse(_mm_sad_epu8(_mm_and_si128(w, data_mask), zero));
+        __m128i received = _mm_and_si128(_mm_srli_epi64(w, cs_shift), low);
+        int mask = _mm_movemask_pd(_mm_castsi128_pd(_mm_cmpeq_epi64(expected, received)));
+        if (ok) {
+            ok[i] = mask & 1;
+            ok[i + 1] = (mask >> 1) & 1;
+        }
+        valid += (size_t)__builtin_popcount((unsigned)mask);
+    }
+    return valid + comchip_verify_scalar(frames + i * frame_len, n - i, frame_len, ok ? ok + i : NULL);
+}
+
+// --- AVX2 Kernel ---
+// Buffers: 32 bytes per step. Frames: four frame words per vector.
+__attribute__((target("avx2")))
+static uint8_t comchip_checksum_avx2(uint8_t cid, const uint8_t* data, size_t len) {
+    __m256i acc = _mm256_setzero_si256();
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+
+    for (; i + 32 <= len; i += 32) {
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_loadu_si256((const __m256i*)(data + i)), zero));
+    }
+    __m128i half = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    uint64_t sum = cid + (uint64_t)_mm_cvtsi128_si64(half) + (uint64_t)_mm_extract_epi64(half, 1);
+    for (; i < len; i++) {
+        sum += data[i];
+    }
+    return comchip_checksum_fold(sum);
+}
+
+__attribute__((target("avx2")))
+static size_t comchip_verify_avx2(const uint8_t* frames, size_t n, size_t frame_len, uint8_t* ok) {
+    if (frame_len > 8) {
+        return comchip_verify_scalar(frames, n, frame_len, ok);
+    }
+    const __m256i data_mask = _mm256_set1_epi64x((long long)(((~0ull) >> (8 * (9 - frame_len))) & ~0xFFull));
+    const __m256i low = _mm256_set1_epi64x(0xFF);
+    const __m256i zero = _mm256_setzero_si256();
+    const int cs_shift = 8 * (int)(frame_len - 1);
+    size_t word_frames = n * frame_len >= 8 ? (n * frame_len - 8) / frame_len + 1 : 0;
+    size_t valid = 0;
+    size_t i = 0;
+
+    for (; i + 4 <= word_frames; i += 4) {
+        const uint8_t* f = frames + i * frame_len;
+        long long w0, w1, w2, w3;
+        memcpy(&w0, f, 8);
+        memcpy(&w1, f + frame_len, 8);
+        memcpy(&w2, f + 2 * frame_len, 8);
+        memcpy(&w3, f + 3 * frame_len, 8);
+        __m256i w = _mm256_set_epi64x(w3, w2, w1, w0);
+
+        __m256i s = _mm256_sad_epu8(_mm256_and_si256(w, data_mask), zero);
+        s = _mm256_add_epi64(_mm256_and_si256(s, low), _mm256_srli_epi64(s, 8));
+        s = _mm256_add_epi64(_mm256_and_si256(s, low), _mm256_srli_epi64(s, 8));
+        __m256i expected = _mm256_xor_si256(s, low);
+        __m256i received = _mm256_and_si256(_mm256_srli_epi64(w, cs_shift), low);
+        int mask = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(expected, received)));
+        if (ok) {
+            ok[i] = mask & 1;
+            ok[i + 1] = (mask >> 1) & 1;
+            ok[i + 2] = (mask >> 2) & 1;
+            ok[i + 3] = (mask >> 3) & 1;
+        }
+        valid += (size_t)__builtin_popcount((unsigned)mask);
+    }
+    return valid + comchip_verify_scalar(frames + i * frame_len, n - i, frame_len, ok ? ok + i : NULL);
+}
+#endif // COMCHIP_CHECKSUM_X86
+
+// --- Kernel Table and Runtime Selection ---
+// Ordered from fastest to slowest; the first supported entry is used.
+static const ComchipChecksumKernel comchip_checksum_kernels[] = {
+#ifdef COMCHIP_CHECKSUM_X86
+    { "avx2",   comchip_checksum_avx2,   comchip_verify_avx2 },
+    { "sse4.1", comchip_checksum_sse41,  comchip_verify_sse41 },
+#endif
+#ifdef COMCHIP_CHECKSUM_LE
+    { "swar",   comchip_checksum_swar,   comchip_verify_swar },
+#endif
+    { "scalar", comchip_checksum_scalar, comchip_verify_scalar },
+};
+
+#define COMCHIP_CHECKSUM_KERNEL_COUNT (sizeof(comchip_checksum_kernels) / sizeof(comchip_checksum_kernels[0]))
+
+static inline bool comchip_checksum_kernel_supported(const ComchipChecksumKernel* k) {
+#ifdef COMCHIP_CHECKSUM_X86
+    __builtin_cpu_init();
+    if (k->checksum == comchip_checksum_avx2) {
+        return __builtin_cpu_supports("avx2");
+    }
+    if (k->checksum == comchip_checksum_sse41) {
+        return __builtin_cpu_supports("sse4.1");
+    }
+#endif
+    (void)k;
+    return true;
+}
+
+static const ComchipChecksumKernel* comchip_checksum_active;
+
+static inline const ComchipChecksumKernel* comchip_checksum_kernel(void) {
+    if (!comchip_checksum_active) {
+        for (size_t i = 0; i < COMCHIP_CHECKSUM_KERNEL_COUNT; i++) {
+            if (comchip_checksum_kernel_supported(&comchip_checksum_kernels[i])) {
+                comchip_checksum_active = &comchip_checksum_kernels[i];
+                break;
+            }
+        }
+    }
+    return comchip_checksum_active;
+}
+
+// --- Public Entry Points ---
+static inline uint8_t comchip_checksum(uint8_t cid, const uint8_t* data, size_t len) {
+    return comchip_checksum_kernel()->checksum(cid, data, len);
+}
+
+static inline size_t comchip_checksum_verify_frames(const uint8_t* frames, size_t n, size_t frame_len, uint8_t* ok) {
+    if (frame_len < 3) {
+        if (ok) {
+            memset(ok, 0, n);
+        }
+        return 0;
+    }
+    return comchip_checksum_kernel()->verify(frames, n, frame_len, ok);
+}
+
+#endif // COMCHIP_CHECKSUM_H
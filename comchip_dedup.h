@@ -0,0 +1,130 @@
+// --- COMChip Change-Only Emission ---
+// A healthy battery answers with the same frame over and over. This stage
+// sits between ingestion and whatever serializes or stores records, and
+// lets a record through only when the device's payload changed: status
+// byte, voltage, or Byte2 where the frame has one. Unchanged frames just
+// bump the device's last-seen time, so "still there, still the same" stays
+// answerable without a record per frame.
+//
+// The comparison runs on a packed 64-bit key per device (status byte,
+// Byte2 and its presence, voltage), i.e. one compare for the common case.
+// With a voltage deadband the voltage is compared apart from the rest: a
+// record goes through only once the voltage moved more than the deadband
+// from the last one let through, so slow drift still gets out while jitter
+// does not.
+//
+// Wiring: initialise ingestion with comchip_dedup_on_batch() and
+// comchip_dedup_on_closed() and the stage as their context; changed
+// records are forwarded in batches to the stage's own callbacks.
+
+#ifndef COMCHIP_DEDUP_H
+#define COMCHIP_DEDUP_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "comchip_event.h"
+#include "comchip_time.h"
+
+// Key layout: voltage in bits 0-15, Byte2 in 16-23, status byte in 24-31,
+// flags above
+#define COMCHIP_DEDUP_VOLTAGE 0x000000000000FFFFull
+#define COMCHIP_DEDUP_BYTE2   (1ull << 32)
+#define COMCHIP_DEDUP_SEEN    (1ull << 33) // Device reported since init or hang-up
+
+typedef struct {
+    uint64_t* key;          // Last key let through, indexed by port id
+    uint64_t* last_seen_ns; // Last frame of any kind, 0 = never
+    uint32_t  cap;
+    uint16_t  deadband_mV;
+
+    ComchipEventBatch out;
+
+    uint64_t frames;
+    uint64_t suppressed;
+} ComchipDedup;
+
+// Returns 0, or -1 with errno set
+static inline int comchip_dedup_init(ComchipDedup* d, uint32_t cap, uint16_t deadband_mV, comchip_batch_cb on_batch,
+                                     comchip_closed_cb on_closed, void* ctx) {
+    memset(d, 0, sizeof(*d));
+    d->key = (uint64_t*)calloc(cap, sizeof(*d->key));
+    d->last_seen_ns = (uint64_t*)calloc(cap, sizeof(*d->last_seen_ns));
+    if (!d->key || !d->last_seen_ns) {
+        free(d->key);
+        free(d->last_seen_ns);
+        errno = ENOMEM;
+        return -1;
+    }
+    d->cap = cap;
+    d->deadband_mV = deadband_mV;
+    comchip_event_batch_init(&d->out, on_batch, on_closed, ctx);
+    return 0;
+}
+
+static inline void comchip_dedup_free(ComchipDedup* d) {
+    free(d->key);
+    free(d->last_seen_ns);
+    memset(d, 0, sizeof(*d));
+}
+
+static inline uint64_t comchip_dedup_key(const BatteryStatusData* data) {
+    return COMCHIP_DEDUP_SEEN | (uint64_t)comchip_status_byte(data) << 24 |
+           (data->has_discharge_status ? COMCHIP_DEDUP_BYTE2 | (uint64_t)data->discharge_status << 16 : 0) |
+           data->battery_voltage_mV;
+}
+
+// --- Records ---
+// True if the record of `dev` taken at ts_ns differs from the last one let
+// through (and becomes the new reference); false if it only bumped last seen
+static inline bool comchip_dedup_check(ComchipDedup* d, uint32_t dev, const BatteryStatusData* data, uint64_t ts_ns) {
+    if (dev >= d->cap) {
+        return true;
+    }
+    d->frames++;
+    d->last_seen_ns[dev] = ts_ns;
+    uint64_t key = comchip_dedup_key(data);
+    uint64_t last = d->key[dev];
+    if (key == last) {
+        d->suppressed++;
+        return false;
+    }
+    if (d->deadband_mV && (key & ~COMCHIP_DEDUP_VOLTAGE) == (last & ~COMCHIP_DEDUP_VOLTAGE)) {
+        int delta = (int)(key & COMCHIP_DEDUP_VOLTAGE) - (int)(last & COMCHIP_DEDUP_VOLTAGE);
+        if (abs(delta) <= d->deadband_mV) {
+            d->suppressed++;
+            return false;
+        }
+    }
+    d->key[dev] = key;
+    return true;
+}
+
+static inline uint64_t comchip_dedup_last_seen(const ComchipDedup* d, uint32_t dev) {
+    return dev < d->cap ? d->last_seen_ns[dev] : 0;
+}
+
+// --- Ingest Callbacks ---
+// ctx is the stage; the whole batch is stamped with its arrival time
+static inline void comchip_dedup_on_batch(void* ctx, const ComchipStatusEvent* events, size_t n) {
+    ComchipDedup* d = (ComchipDedup*)ctx;
+    uint64_t now = comchip_now_ns();
+    for (size_t i = 0; i < n; i++) {
+        if (comchip_dedup_check(d, events[i].port, &events[i].data, now)) {
+            comchip_event_batch_push(&d->out, events[i].port, &events[i].data);
+        }
+    }
+    comchip_event_batch_flush(&d->out);
+}
+
+// Forgets the port, so whatever answers on it next is let through in full
+static inline void comchip_dedup_on_closed(void* ctx, uint32_t port) {
+    ComchipDedup* d = (ComchipDedup*)ctx;
+    if (port < d->cap) {
+        d->key[port] = 0;
+    }
+    comchip_event_batch_closed(&d->out, port);
+}
+
+#endif // COMCHIP_DEDUP_H
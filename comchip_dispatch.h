@@ -0,0 +1,145 @@
+// --- COMChip CID Dispatch Table ---
+// A 256-entry table indexed by the CID byte. Each entry holds the frame
+// length for that response type, an optional validator and the handler that
+// decodes it. A mixed stream carrying several response types is decoded in
+// one pass: find SYNC, index the table with the next byte, check the
+// checksum, then one indirect call into the handler.
+//
+// Unregistered CIDs have frame_len 0, so the SYNC byte in front of them is
+// treated as line noise and skipped.
+
+#ifndef COMCHIP_DISPATCH_H
+#define COMCHIP_DISPATCH_H
+
+#include <string.h>
+
+#include "comchip.h"
+#include "comchip_layout.h"
+
+// Decode one validated frame. `frame` points at SYNC and holds frame_len bytes.
+typedef void (*comchip_cid_handler)(void* ctx, const uint8_t* frame, uint8_t frame_len);
+
+// Extra check on top of the checksum (e.g. reserved bits); NULL = checksum only
+typedef bool (*comchip_cid_validator)(const uint8_t* frame, uint8_t frame_len);
+
+typedef struct {
+    uint8_t               frame_len; // 0 = CID not registered
+    comchip_cid_validator validate;
+    comchip_cid_handler   handler;
+    void*                 ctx;
+    uint64_t              frames;    // Frames dispatched to this entry
+} ComchipCidEntry;
+
+typedef struct {
+    ComchipCidEntry entries[256];
+
+    // Counters for link diagnostics
+    uint64_t bytes_skipped;
+    uint64_t unknown_cids;
+    uint64_t invalid_frames;      // Checksum or validator failed
+} ComchipDispatch;
+
+static inline void comchip_dispatch_init(ComchipDispatch* d) {
+    memset(d, 0, sizeof(*d));
+}
+
+// Register (or replace) the handler for one response CID.
+// Returns false if the frame length cannot hold the SYNC/CID/checksum envelope.
+static inline bool comchip_dispatch_register(ComchipDispatch* d, uint8_t cid, uint8_t frame_len,
+                                             comchip_cid_validator validate, comchip_cid_handler handler, void* ctx) {
+    if (frame_len < COMCHIP_ENVELOPE_LEN || !handler) {
+        return false;
+    }
+    ComchipCidEntry* e = &d->entries[cid];
+    e->frame_len = frame_len;
+    e->validate = validate;
+    e->handler = handler;
+    e->ctx = ctx;
+    e->frames = 0;
+    return true;
+}
+
+static inline void comchip_dispatch_unregister(ComchipDispatch* d, uint8_t cid) {
+    memset(&d->entries[cid], 0, sizeof(d->entries[cid]));
+}
+
+// --- Built-in Handler: 'Get Battery Status' Response ---
+// 0x81 exists as a 6-byte and a 7-byte frame; a port uses one of them, so
+// the status handler is registered with that port's layout length.
+typedef struct {
+    void (*on_status)(void* ctx, const BatteryStatusData* data);
+    void* ctx;
+} ComchipStatusHandler;
+
+static inline void comchip_dispatch_status6(void* ctx, const uint8_t* frame, uint8_t frame_len) {
+    const ComchipStatusHandler* h = (const ComchipStatusHandler*)ctx;
+    BatteryStatusData data;
+    (void)frame_len;
+    comchip_layout_decode(frame, COMCHIP_LAYOUT_STATUS6, &data);
+    h->on_status(h->ctx, &data);
+}
+
+static inline void comchip_dispatch_status7(void* ctx, const uint8_t* frame, uint8_t frame_len) {
+    const ComchipStatusHandler* h = (const ComchipStatusHandler*)ctx;
+    BatteryStatusData data;
+    (void)frame_len;
+    comchip_layout_decode(frame, COMCHIP_LAYOUT_STATUS7, &data);
+    h->on_status(h->ctx, &data);
+}
+
+static inline bool comchip_dispatch_register_status(ComchipDispatch* d, uint8_t frame_len, ComchipStatusHandler* h) {
+    if (frame_len == COMCHIP_STATUS_FRAME_LEN) {
+        return comchip_dispatch_register(d, COMCHIP_CID_GET_STATUS_RESP, frame_len, NULL, comchip_dispatch_status6, h);
+    }
+    if (frame_len == COMCHIP_STATUS_FRAME_LEN_BYTE2) {
+        return comchip_dispatch_register(d, COMCHIP_CID_GET_STATUS_RESP, frame_len, NULL, comchip_dispatch_status7, h);
+    }
+    return false;
+}
+
+// --- Decode a Mixed Stream in One Pass ---
+// Returns the number of bytes consumed. Bytes after that point start a frame
+// that is not complete yet; the caller keeps them and passes them again,
+// followed by new data, on the next call.
+static inline size_t comchip_dispatch_feed(ComchipDispatch* d, const uint8_t* buf, size_t len) {
+    size_t i = 0;
+
+    while (i < len) {
+        const uint8_t* p = (const uint8_t*)memchr(buf + i, COMCHIP_SYNC_BYTE, len - i);
+        if (!p) {
+            d->bytes_skipped += len - i;
+            return len;
+        }
+        d->bytes_skipped += (size_t)(p - (buf + i));
+        i = (size_t)(p - buf);
+
+        if (len - i < 2) {
+            return i; // CID not received yet
+        }
+        ComchipCidEntry* e = &d->entries[buf[i + COMCHIP_CID_INDEX]];
+        if (e->frame_len == 0) {
+            d->unknown_cids++;
+            d->bytes_skipped++;
+            i++;
+            continue;
+        }
+        if (len - i < e->frame_len) {
+            return i; // Frame not complete yet
+        }
+
+        const uint8_t* f = buf + i;
+        if (comchip_frame_checksum(f, e->frame_len) != f[e->frame_len - 1] ||
+            (e->validate && !e->validate(f, e->frame_len))) {
+            d->invalid_frames++;
+            d->bytes_skipped++;
+            i++;
+            continue;
+        }
+        e->frames++;
+        e->handler(e->ctx, f, e->frame_len);
+        i += e->frame_len;
+    }
+    return i;
+}
+
+#endif // COMCHIP_DISPATCH_H
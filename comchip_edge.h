@@ -0,0 +1,166 @@
+// --- COMChip Alarm Edge Detection ---
+// Turns a stream of decoded statuses into the few moments that matter: a
+// battery error, under voltage or "not supported" flag changing. Each device
+// keeps the status byte it last reported; a new status is XORed against it,
+// and the common case of nothing changing costs that one XOR and a compare.
+// Changed bits become ComchipEdgeEvents (device, flag, old, new, timestamp).
+//
+// Debounce: with debounce_ns > 0 a changed flag is only reported once a
+// sample at least debounce_ns after the first one still shows it. A flag
+// that flips back before that is dropped, and counted as a bounce. The
+// change is stamped with the time it was first seen, not confirmed.
+//
+// Every device starts from an all-clear status byte (0: no error, no under
+// voltage, supported), so a flag already raised on the first sample is
+// reported like any other change.
+
+#ifndef COMCHIP_EDGE_H
+#define COMCHIP_EDGE_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "comchip_event.h"
+#include "comchip_time.h"
+
+#define COMCHIP_EDGE_FLAGS (STATUS_BIT_BATTERY_ERROR | STATUS_BIT_UNDER_VOLTAGE | STATUS_BIT_NOT_SUPPORTED)
+
+typedef struct {
+    uint64_t timestamp_ns;
+    uint32_t port;
+    uint8_t  flag; // One STATUS_BIT_* (NOT_SUPPORTED set = battery not supported)
+    bool     old_value;
+    bool     new_value;
+} ComchipEdgeEvent;
+
+typedef void (*comchip_edge_cb)(void* ctx, const ComchipEdgeEvent* ev);
+
+typedef struct {
+    uint8_t  pending;     // Changed bits waiting for debounce
+    uint64_t since_ns[8]; // First seen, per pending bit
+} ComchipEdgePending;
+
+typedef struct {
+    uint8_t*            status;  // Reported status byte, indexed by port id
+    ComchipEdgePending* pending; // Indexed by port id, NULL without debounce
+    uint32_t            cap;
+    uint8_t             mask;    // Flags watched, COMCHIP_EDGE_FLAGS by default
+    uint64_t            debounce_ns;
+
+    comchip_edge_cb on_edge;
+    void*           ctx;
+
+    uint64_t samples;
+    uint64_t events;
+    uint64_t bounces; // Changes that reverted within the debounce time
+} ComchipEdgeDetector;
+
+// Returns 0, or -1 with errno set
+static inline int comchip_edge_init(ComchipEdgeDetector* d, uint32_t cap, uint64_t debounce_ns,
+                                    comchip_edge_cb on_edge, void* ctx) {
+    memset(d, 0, sizeof(*d));
+    d->status = (uint8_t*)calloc(cap, 1);
+    if (debounce_ns) {
+        d->pending = (ComchipEdgePending*)calloc(cap, sizeof(*d->pending));
+    }
+    if (!d->status || (debounce_ns && !d->pending)) {
+        free(d->status);
+        free(d->pending);
+        errno = ENOMEM;
+        return -1;
+    }
+    d->cap = cap;
+    d->mask = COMCHIP_EDGE_FLAGS;
+    d->debounce_ns = debounce_ns;
+    d->on_edge = on_edge;
+    d->ctx = ctx;
+    return 0;
+}
+
+static inline void comchip_edge_free(ComchipEdgeDetector* d) {
+    free(d->status);
+    free(d->pending);
+    memset(d, 0, sizeof(*d));
+}
+
+// --- Transitions ---
+static inline void comchip_edge_emit(ComchipEdgeDetector* d, uint32_t port, uint8_t bit, uint8_t status,
+                                     uint64_t ts_ns) {
+    ComchipEdgeEvent ev;
+    ev.timestamp_ns = ts_ns;
+    ev.port = port;
+    ev.flag = bit;
+    ev.old_value = (status & bit) != 0;
+    ev.new_value = !ev.old_value;
+    d->status[port] = (uint8_t)(status ^ bit);
+    d->events++;
+    d->on_edge(d->ctx, &ev);
+}
+
+// Slow path: some watched bit differs from the reported status, or waits
+static inline void comchip_edge_changed(ComchipEdgeDetector* d, uint32_t port, uint8_t diff, uint64_t ts_ns) {
+    if (!d->pending) {
+        while (diff) {
+            uint8_t bit = (uint8_t)(diff & -diff);
+            comchip_edge_emit(d, port, bit, d->status[port], ts_ns);
+            diff ^= bit;
+        }
+        return;
+    }
+
+    ComchipEdgePending* p = &d->pending[port];
+    uint8_t bounced = p->pending & ~diff;
+    d->bounces += (uint64_t)__builtin_popcount(bounced);
+    p->pending &= diff;
+    for (uint8_t fresh = diff & ~p->pending; fresh; fresh &= (uint8_t)(fresh - 1)) {
+        p->since_ns[__builtin_ctz(fresh)] = ts_ns;
+    }
+    p->pending = diff;
+    for (uint8_t bits = diff; bits; bits &= (uint8_t)(bits - 1)) {
+        unsigned i = (unsigned)__builtin_ctz(bits);
+        if (ts_ns - p->since_ns[i] >= d->debounce_ns) {
+            uint8_t bit = (uint8_t)(1u << i);
+            p->pending ^= bit;
+            comchip_edge_emit(d, port, bit, d->status[port], p->since_ns[i]);
+        }
+    }
+}
+
+// Feed one status of `port` taken at ts_ns
+static inline void comchip_edge_feed_byte(ComchipEdgeDetector* d, uint32_t port, uint8_t status, uint64_t ts_ns) {
+    if (port >= d->cap) {
+        return;
+    }
+    d->samples++;
+    uint8_t diff = (uint8_t)((status ^ d->status[port]) & d->mask);
+    if (diff == 0 && (!d->pending || d->pending[port].pending == 0)) {
+        return;
+    }
+    comchip_edge_changed(d, port, diff, ts_ns);
+}
+
+static inline void comchip_edge_feed(ComchipEdgeDetector* d, uint32_t port, const BatteryStatusData* data,
+                                     uint64_t ts_ns) {
+    comchip_edge_feed_byte(d, port, comchip_status_byte(data), ts_ns);
+}
+
+// --- Callbacks ---
+// Ingest batch callback (see comchip_event.h); ctx is the detector, and the
+// whole batch is stamped with its arrival time
+static inline void comchip_edge_on_batch(void* ctx, const ComchipStatusEvent* events, size_t n) {
+    ComchipEdgeDetector* d = (ComchipEdgeDetector*)ctx;
+    uint64_t now = comchip_now_ns();
+    for (size_t i = 0; i < n; i++) {
+        comchip_edge_feed(d, events[i].port, &events[i].data, now);
+    }
+}
+
+// Engine response callback (see comchip_engine.h); ctx is the detector
+static inline void comchip_edge_on_response(void* ctx, uint32_t dev, const BatteryStatusData* data,
+                                            uint64_t rtt_ns) {
+    (void)rtt_ns;
+    comchip_edge_feed((ComchipEdgeDetector*)ctx, dev, data, comchip_now_ns());
+}
+
+#endif // COMCHIP_EDGE_H
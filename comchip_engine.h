@@ -0,0 +1,348 @@
+// --- COMChip Request/Response Engine ---
+// Polls many devices at once instead of one request-wait-response at a time.
+// Every device (one per port, identified by its ingestion port id) has a
+// window of requests that may be outstanding; the engine keeps each window
+// full, matches responses to requests, expires requests that miss their
+// deadline and retries them with exponential backoff.
+//
+// A status response carries no sequence number, so matching is by order:
+// on one link the device answers requests in the order it received them,
+// and a response belongs to the oldest request still in flight on that port.
+// A timeout drops the whole window (the device is presumed to have lost
+// them) and resends after the backoff; a response that turns up late finds
+// nothing in flight and is counted as unmatched. With window 1 this is
+// classic polling, just overlapped across all ports.
+//
+// Every device has one deadline timer on a timing wheel (comchip_wheel.h),
+// armed for its oldest request's deadline or, while backing off, for the end
+// of the backoff, plus an optional watchdog that fires when the port has
+// delivered no frame at all for a while (stalled link). Nothing is scanned
+// per device: a response refills its window on the spot, and the wheel only
+// touches devices whose timer expired.
+//
+// Wiring: register comchip_engine_on_batch() as the ingestion backend's batch
+// callback with the engine as its context, attach each port's fd, and call
+// comchip_engine_tick() around every run_once(); it runs expired timers and
+// returns the timeout for the wait.
+
+#ifndef COMCHIP_ENGINE_H
+#define COMCHIP_ENGINE_H
+
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "comchip_event.h"
+#include "comchip_frame.h"
+#include "comchip_time.h"
+#include "comchip_wheel.h"
+
+#define COMCHIP_ENGINE_MAX_WINDOW  8
+#define COMCHIP_ENGINE_TIMEOUT_NS  (50 * COMCHIP_NS_PER_MS)   // Per-request deadline
+#define COMCHIP_ENGINE_BACKOFF_NS  (10 * COMCHIP_NS_PER_MS)   // First retry delay, doubled per attempt
+#define COMCHIP_ENGINE_BACKOFF_MAX (1000 * COMCHIP_NS_PER_MS)
+#define COMCHIP_ENGINE_MAX_RETRIES 3                          // Before a poll is given up
+#define COMCHIP_ENGINE_TICK_NS     COMCHIP_NS_PER_MS            // Timer resolution
+
+#define COMCHIP_POLL_CONTINUOUS    UINT32_MAX // Poll again as soon as the window allows, forever
+
+typedef struct {
+    uint64_t sent_ns;
+    uint64_t deadline_ns;
+} ComchipInflight;
+
+typedef struct ComchipEngine ComchipEngine;
+
+typedef struct {
+    ComchipEngine* engine;
+    uint32_t id;             // Port id
+    int      fd;             // -1 = not attached
+    uint8_t  window;         // Requests allowed in flight
+    uint8_t  inflight_head;
+    uint8_t  inflight_count;
+    ComchipInflight inflight[COMCHIP_ENGINE_MAX_WINDOW];
+    uint32_t pending;        // Polls not sent yet
+    uint8_t  attempt;        // Consecutive timeouts
+    uint64_t not_before_ns;  // Backoff: nothing is sent before this
+    ComchipTimer timer;      // Oldest deadline, or end of backoff
+    ComchipTimer watchdog;   // No frame received for watchdog_ns
+
+    // Round-trip time of matched responses
+    uint64_t rtt_last_ns;
+    uint64_t rtt_min_ns;
+    uint64_t rtt_max_ns;
+    uint64_t rtt_sum_ns;
+
+    // Counters
+    uint64_t requests_sent;
+    uint64_t responses;
+    uint64_t timeouts;
+    uint64_t failures;       // Polls given up after COMCHIP_ENGINE_MAX_RETRIES
+    uint64_t unmatched;      // Responses with nothing in flight
+    uint64_t stalls;         // Watchdog expiries
+} ComchipDevice;
+
+typedef void (*comchip_response_cb)(void* ctx, uint32_t dev, const BatteryStatusData* data, uint64_t rtt_ns);
+typedef void (*comchip_failure_cb)(void* ctx, uint32_t dev);
+typedef void (*comchip_stalled_cb)(void* ctx, uint32_t dev);
+
+struct ComchipEngine {
+    ComchipDevice* devices;     // Indexed by port id
+    uint32_t       devices_cap;
+    ComchipWheel   wheel;
+
+    comchip_response_cb on_response;
+    comchip_failure_cb  on_failure; // May be NULL
+    comchip_stalled_cb  on_stalled; // May be NULL
+    void*               ctx;
+
+    uint64_t timeout_ns;
+    uint64_t backoff_ns;
+    uint64_t backoff_max_ns;
+    uint8_t  max_retries;
+    uint64_t watchdog_ns;       // 0 = no watchdog
+};
+
+// --- Setup ---
+// devices_cap matches the ingestion backend's ports_cap. Returns 0, or -1 with errno set.
+static inline int comchip_engine_init(ComchipEngine* e, uint32_t devices_cap, comchip_response_cb on_response,
+                                      comchip_failure_cb on_failure, void* ctx) {
+    memset(e, 0, sizeof(*e));
+    e->devices = (ComchipDevice*)calloc(devices_cap, sizeof(*e->devices));
+    if (!e->devices) {
+        errno = ENOMEM;
+        return -1;
+    }
+    for (uint32_t i = 0; i < devices_cap; i++) {
+        e->devices[i].fd = -1;
+    }
+    e->devices_cap = devices_cap;
+    comchip_wheel_init(&e->wheel, COMCHIP_ENGINE_TICK_NS, comchip_now_ns());
+    e->on_response = on_response;
+    e->on_failure = on_failure;
+    e->ctx = ctx;
+    e->timeout_ns = COMCHIP_ENGINE_TIMEOUT_NS;
+    e->backoff_ns = COMCHIP_ENGINE_BACKOFF_NS;
+    e->backoff_max_ns = COMCHIP_ENGINE_BACKOFF_MAX;
+    e->max_retries = COMCHIP_ENGINE_MAX_RETRIES;
+    return 0;
+}
+
+static inline void comchip_engine_free(ComchipEngine* e) {
+    free(e->devices);
+    memset(e, 0, sizeof(*e));
+}
+
+static void comchip_engine_on_timer(void* ctx, ComchipTimer* t);
+static void comchip_engine_on_watchdog(void* ctx, ComchipTimer* t);
+
+// Report ports that deliver no frame for `ns` (0 turns the watchdog off).
+// Applies to devices attached afterwards.
+static inline void comchip_engine_set_watchdog(ComchipEngine* e, uint64_t ns, comchip_stalled_cb on_stalled) {
+    e->watchdog_ns = ns;
+    e->on_stalled = on_stalled;
+}
+
+// Start tracking the device on port `dev`. fd is the port's fd, still owned
+// by the ingestion backend; requests are written to it. fd is made
+// non-blocking (if it is not already) so a full output queue can never stall
+// the event loop, whichever backend reads from the port.
+static inline bool comchip_engine_attach(ComchipEngine* e, uint32_t dev, int fd, uint8_t window) {
+    if (dev >= e->devices_cap || window == 0 || window > COMCHIP_ENGINE_MAX_WINDOW) {
+        return false;
+    }
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || (!(flags & O_NONBLOCK) && fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)) {
+        return false;
+    }
+    ComchipDevice* d = &e->devices[dev];
+    comchip_timer_cancel(&e->wheel, &d->timer);
+    comchip_timer_cancel(&e->wheel, &d->watchdog);
+    memset(d, 0, sizeof(*d));
+    d->engine = e;
+    d->id = dev;
+    d->fd = fd;
+    d->window = window;
+    d->rtt_min_ns = UINT64_MAX;
+    comchip_timer_init(&d->timer, comchip_engine_on_timer, d);
+    comchip_timer_init(&d->watchdog, comchip_engine_on_watchdog, d);
+    if (e->watchdog_ns) {
+        comchip_timer_arm(&e->wheel, &d->watchdog, comchip_now_ns() + e->watchdog_ns);
+    }
+    return true;
+}
+
+// Stop tracking (e.g. from the ingestion backend's closed callback)
+static inline void comchip_engine_detach(ComchipEngine* e, uint32_t dev) {
+    ComchipDevice* d = &e->devices[dev];
+    comchip_timer_cancel(&e->wheel, &d->timer);
+    comchip_timer_cancel(&e->wheel, &d->watchdog);
+    d->fd = -1;
+}
+
+// --- Sending ---
+// Fill the window if the device is not backing off
+static inline void comchip_engine_send(ComchipEngine* e, ComchipDevice* d, uint64_t now) {
+    if (d->pending == 0 || d->inflight_count == d->window || now < d->not_before_ns) {
+        return;
+    }
+    uint32_t k = (uint32_t)(d->window - d->inflight_count);
+    if (d->pending < k) {
+        k = d->pending;
+    }
+
+    // All requests for the window go out in one write()
+    uint8_t tx[COMCHIP_ENGINE_MAX_WINDOW * COMCHIP_STATUS_REQ_FRAME_LEN];
+    size_t len = comchip_encode_status_requests(tx, sizeof(tx), k);
+    ssize_t written = write(d->fd, tx, len); // Non-blocking, see comchip_engine_attach()
+    if (written <= 0) {
+        return; // Output queue full (EAGAIN) or port gone; retried by the timer
+    }
+    // A short write is rare with requests this small; only whole frames count as sent
+    uint32_t sent = (uint32_t)((size_t)written / COMCHIP_STATUS_REQ_FRAME_LEN);
+
+    for (uint32_t i = 0; i < sent; i++) {
+        ComchipInflight* req = &d->inflight[(d->inflight_head + d->inflight_count) % COMCHIP_ENGINE_MAX_WINDOW];
+        req->sent_ns = now;
+        req->deadline_ns = now + e->timeout_ns;
+        d->inflight_count++;
+    }
+    d->requests_sent += sent;
+    if (d->pending != COMCHIP_POLL_CONTINUOUS) {
+        d->pending -= sent;
+    }
+}
+
+// Point the device's timer at whatever it waits for next
+static inline void comchip_engine_rearm(ComchipEngine* e, ComchipDevice* d, uint64_t now) {
+    if (d->inflight_count) {
+        comchip_timer_arm(&e->wheel, &d->timer, d->inflight[d->inflight_head].deadline_ns);
+    } else if (d->pending && d->not_before_ns > now) {
+        comchip_timer_arm(&e->wheel, &d->timer, d->not_before_ns);
+    } else if (d->pending) {
+        comchip_timer_arm(&e->wheel, &d->timer, now + e->wheel.tick_ns); // A write did not go through
+    } else {
+        comchip_timer_cancel(&e->wheel, &d->timer);
+    }
+}
+
+// Queue `count` status polls (COMCHIP_POLL_CONTINUOUS: keep polling) and send
+// what the window allows right away. False (nothing queued) if no device is
+// attached on port `dev`.
+static inline bool comchip_engine_poll(ComchipEngine* e, uint32_t dev, uint32_t count) {
+    if (dev >= e->devices_cap || e->devices[dev].fd < 0) {
+        return false;
+    }
+    ComchipDevice* d = &e->devices[dev];
+    if (count == COMCHIP_POLL_CONTINUOUS || d->pending > COMCHIP_POLL_CONTINUOUS - 1 - count) {
+        d->pending = COMCHIP_POLL_CONTINUOUS;
+    } else {
+        d->pending += count;
+    }
+    uint64_t now = comchip_now_ns();
+    comchip_engine_send(e, d, now);
+    comchip_engine_rearm(e, d, now);
+    return true;
+}
+
+// --- Timers ---
+// The oldest request missed its deadline, or a backoff ended
+static void comchip_engine_on_timer(void* ctx, ComchipTimer* t) {
+    ComchipDevice* d = (ComchipDevice*)ctx;
+    ComchipEngine* e = d->engine;
+    uint64_t now = comchip_now_ns();
+    (void)t;
+
+    if (d->inflight_count && d->inflight[d->inflight_head].deadline_ns <= now) {
+        // Everything behind the expired request is presumed lost too
+        d->timeouts++;
+        uint8_t lost = d->inflight_count;
+        d->inflight_count = 0;
+        if (++d->attempt > e->max_retries) {
+            d->failures++;
+            d->attempt = 0;
+            lost--; // The oldest poll is given up, the rest are resent
+            if (e->on_failure) {
+                e->on_failure(e->ctx, d->id);
+            }
+        }
+        if (d->pending != COMCHIP_POLL_CONTINUOUS) {
+            d->pending += lost;
+        }
+
+        uint64_t backoff = d->attempt ? e->backoff_ns << (d->attempt - 1) : 0;
+        d->not_before_ns = now + (backoff < e->backoff_max_ns ? backoff : e->backoff_max_ns);
+    }
+    if (d->fd < 0) {
+        return; // Detached from on_failure
+    }
+    comchip_engine_send(e, d, now);
+    comchip_engine_rearm(e, d, now);
+}
+
+static void comchip_engine_on_watchdog(void* ctx, ComchipTimer* t) {
+    ComchipDevice* d = (ComchipDevice*)ctx;
+    ComchipEngine* e = d->engine;
+    d->stalls++;
+    comchip_timer_arm(&e->wheel, t, comchip_now_ns() + e->watchdog_ns); // Keep reporting while stalled
+    if (e->on_stalled) {
+        e->on_stalled(e->ctx, d->id);
+    }
+}
+// --- Responses ---
+// Batch callback for the ingestion backend; ctx is the engine
+static inline void comchip_engine_on_batch(void* ctx, const ComchipStatusEvent* events, size_t n) {
+    ComchipEngine* e = (ComchipEngine*)ctx;
+    uint64_t now = comchip_now_ns();
+
+    for (size_t i = 0; i < n; i++) {
+        if (events[i].port >= e->devices_cap) {
+            continue;
+        }
+        ComchipDevice* d = &e->devices[events[i].port];
+        if (d->fd < 0) {
+            continue;
+        }
+        if (e->watchdog_ns) {
+            comchip_timer_arm(&e->wheel, &d->watchdog, now + e->watchdog_ns);
+        }
+        if (d->inflight_count == 0) {
+            d->unmatched++;
+            continue;
+        }
+
+        const ComchipInflight* req = &d->inflight[d->inflight_head];
+        uint64_t rtt = now - req->sent_ns;
+        d->inflight_head = (uint8_t)((d->inflight_head + 1) % COMCHIP_ENGINE_MAX_WINDOW);
+        d->inflight_count--;
+        d->attempt = 0;
+
+        d->responses++;
+        d->rtt_last_ns = rtt;
+        d->rtt_sum_ns += rtt;
+        if (rtt < d->rtt_min_ns) {
+            d->rtt_min_ns = rtt;
+        }
+        if (rtt > d->rtt_max_ns) {
+            d->rtt_max_ns = rtt;
+        }
+        e->on_response(e->ctx, events[i].port, &events[i].data, rtt);
+
+        // Refill the window on the spot instead of waiting for a scan
+        if (d->fd >= 0) {
+            comchip_engine_send(e, d, now);
+            comchip_engine_rearm(e, d, now);
+        }
+    }
+}
+
+// --- Event Loop ---
+// Run expired deadline, backoff and watchdog timers. Returns the timeout in
+// milliseconds for the next run_once() (-1 when no timer is armed).
+static inline int comchip_engine_tick(ComchipEngine* e) {
+    comchip_wheel_advance(&e->wheel, comchip_now_ns());
+    return comchip_wheel_timeout_ms(&e->wheel, comchip_now_ns());
+}
+
+#endif // COMCHIP_ENGINE_H
@@ -0,0 +1,70 @@
+// --- COMChip Status Events and Batched Delivery ---
+// Ingestion backends (comchip_reactor.h, comchip_uring.h) decode many ports
+// at once. Each decoded frame becomes a ComchipStatusEvent tagged with its
+// port id, and events are handed to the application in batches rather than
+// one callback per frame.
+
+#ifndef COMCHIP_EVENT_H
+#define COMCHIP_EVENT_H
+
+#include "comchip.h"
+
+#define COMCHIP_EVENT_BATCH 256 // Decoded frames per batch callback
+
+typedef struct {
+    uint32_t          port; // Id returned by the backend's add()
+    BatteryStatusData data;
+} ComchipStatusEvent;
+
+typedef void (*comchip_batch_cb)(void* ctx, const ComchipStatusEvent* events, size_t n);
+typedef void (*comchip_closed_cb)(void* ctx, uint32_t port);
+
+typedef struct {
+    ComchipStatusEvent events[COMCHIP_EVENT_BATCH];
+    size_t             len;
+
+    comchip_batch_cb  on_batch;
+    comchip_closed_cb on_closed; // May be NULL
+    void*             ctx;
+
+    uint64_t batches;
+    uint64_t frames;  // Frames delivered through on_batch
+} ComchipEventBatch;
+
+static inline void comchip_event_batch_init(ComchipEventBatch* b, comchip_batch_cb on_batch,
+                                            comchip_closed_cb on_closed, void* ctx) {
+    b->len = 0;
+    b->on_batch = on_batch;
+    b->on_closed = on_closed;
+    b->ctx = ctx;
+    b->batches = 0;
+    b->frames = 0;
+}
+
+static inline void comchip_event_batch_flush(ComchipEventBatch* b) {
+    if (b->len) {
+        b->batches++;
+        b->frames += b->len;
+        b->on_batch(b->ctx, b->events, b->len);
+        b->len = 0;
+    }
+}
+
+static inline void comchip_event_batch_push(ComchipEventBatch* b, uint32_t port, const BatteryStatusData* data) {
+    if (b->len == COMCHIP_EVENT_BATCH) {
+        comchip_event_batch_flush(b);
+    }
+    b->events[b->len].port = port;
+    b->events[b->len].data = *data;
+    b->len++;
+}
+
+// A port hung up; its last frames are delivered first
+static inline void comchip_event_batch_closed(ComchipEventBatch* b, uint32_t port) {
+    comchip_event_batch_flush(b);
+    if (b->on_closed) {
+        b->on_closed(b->ctx, port);
+    }
+}
+
+#endif // COMCHIP_EVENT_H
@@ -0,0 +1,99 @@
+// --- COMChip Frame Builder and Request Encoder ---
+// COMCHIP_FRAME(cid, data...) expands to a complete frame initializer
+//     { SYNC, CID, data..., Checksum }
+// with the checksum computed by the compiler, so fixed request frames and
+// sample frames cost nothing at runtime and can be checked with
+// _Static_assert. The checksum macro uses the sum-then-fold form of the
+// document's algorithm (see comchip_checksum.h), which gives the same value
+// as calculate_checksum() but stays one small constant expression.
+//
+// comchip_encode_frames() is the runtime counterpart for requests whose
+// payload varies: it writes many frames straight into a caller's buffer.
+
+#ifndef COMCHIP_FRAME_H
+#define COMCHIP_FRAME_H
+
+#include <string.h>
+
+#include "comchip.h"
+
+// --- Compile-Time Checksum ---
+// Sum of up to 8 arguments
+#define COMCHIP_SUM_1(a) (a)
+#define COMCHIP_SUM_2(a, ...) ((a) + COMCHIP_SUM_1(__VA_ARGS__))
+#define COMCHIP_SUM_3(a, ...) ((a) + COMCHIP_SUM_2(__VA_ARGS__))
+#define COMCHIP_SUM_4(a, ...) ((a) + COMCHIP_SUM_3(__VA_ARGS__))
+#define COMCHIP_SUM_5(a, ...) ((a) + COMCHIP_SUM_4(__VA_ARGS__))
+#define COMCHIP_SUM_6(a, ...) ((a) + COMCHIP_SUM_5(__VA_ARGS__))
+#define COMCHIP_SUM_7(a, ...) ((a) + COMCHIP_SUM_6(__VA_ARGS__))
+#define COMCHIP_SUM_8(a, ...) ((a) + COMCHIP_SUM_7(__VA_ARGS__))
+#define COMCHIP_SUM_9(a, ...) ((a) + COMCHIP_SUM_8(__VA_ARGS__))
+
+#define COMCHIP_ARG_COUNT(...) COMCHIP_ARG_COUNT_(__VA_ARGS__, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define COMCHIP_ARG_COUNT_(_1, _2, _3, _4, _5, _6, _7, _8, _9, n, ...) n
+#define COMCHIP_CONCAT(a, b) COMCHIP_CONCAT_(a, b)
+#define COMCHIP_CONCAT_(a, b) a##b
+#define COMCHIP_SUM(...) COMCHIP_CONCAT(COMCHIP_SUM_, COMCHIP_ARG_COUNT(__VA_ARGS__))(__VA_ARGS__)
+
+// Fold a byte sum the way the per-add `tmp -= 255u` does: 0 stays 0,
+// anything else lands in 1..255
+#define COMCHIP_CHECKSUM_FROM_SUM(s) ((uint8_t)(~((s) == 0 ? 0 : ((s) - 1) % 255 + 1) & 0xFF))
+
+// Checksum of CID followed by up to 8 data bytes, as a constant expression
+#define COMCHIP_CHECKSUM(...) COMCHIP_CHECKSUM_FROM_SUM(COMCHIP_SUM(__VA_ARGS__))
+
+// --- Compile-Time Frames ---
+// Frame bytes without braces, for embedding in a larger initializer
+#define COMCHIP_FRAME_BYTES(...) COMCHIP_SYNC_BYTE, __VA_ARGS__, COMCHIP_CHECKSUM(__VA_ARGS__)
+// Complete frame initializer: uint8_t frame[] = COMCHIP_FRAME(cid, data...);
+#define COMCHIP_FRAME(...) { COMCHIP_FRAME_BYTES(__VA_ARGS__) }
+
+// 'Get Battery Status' request: SYNC | CID | Checksum, no data
+static const uint8_t comchip_get_status_request[COMCHIP_STATUS_REQ_FRAME_LEN] =
+    COMCHIP_FRAME(COMCHIP_CID_GET_STATUS_REQ);
+
+_Static_assert(COMCHIP_CHECKSUM(COMCHIP_CID_GET_STATUS_REQ) == 0xFE, "Get Battery Status request checksum");
+
+// --- Runtime Encoder ---
+// Write n frames with the same CID back to back into out. payloads holds
+// n * payload_len data bytes, one payload after another (NULL when
+// payload_len is 0). Returns the bytes written, or 0 if out_cap is too small.
+static inline size_t comchip_encode_frames(uint8_t* out, size_t out_cap, uint8_t cid,
+                                           const uint8_t* payloads, size_t payload_len, size_t n) {
+    size_t frame_len = payload_len + COMCHIP_ENVELOPE_LEN;
+    if (frame_len >= 256 || n > out_cap / frame_len) {
+        return 0;
+    }
+
+    uint8_t* p = out;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t sum = cid;
+        p[COMCHIP_SYNC_INDEX] = COMCHIP_SYNC_BYTE;
+        p[COMCHIP_CID_INDEX] = cid;
+        for (size_t k = 0; k < payload_len; k++) {
+            uint8_t b = payloads[i * payload_len + k];
+            p[COMCHIP_DATA_INDEX + k] = b;
+            sum += b;
+        }
+        sum = (sum & 0xFFu) + (sum >> 8);
+        sum = (sum & 0xFFu) + (sum >> 8);
+        p[frame_len - 1] = (uint8_t)(~sum & 0xFFu);
+        p += frame_len;
+    }
+    return n * frame_len;
+}
+
+// Write n copies of the fixed 'Get Battery Status' request (e.g. one per
+// device on a polling cycle). The frame was built at compile time.
+static inline size_t comchip_encode_status_requests(uint8_t* out, size_t out_cap, size_t n) {
+    if (n > out_cap / sizeof(comchip_get_status_request)) {
+        return 0;
+    }
+    for (size_t i = 0; i < n; i++) {
+        memcpy(out + i * sizeof(comchip_get_status_request), comchip_get_status_request,
+               sizeof(comchip_get_status_request));
+    }
+    return n * sizeof(comchip_get_status_request);
+}
+
+#endif // COMCHIP_FRAME_H
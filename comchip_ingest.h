@@ -0,0 +1,117 @@
+// --- COMChip Ingestion Backends ---
+// One interface over the ways of reading many ports on one thread:
+//     io_uring  reads stay posted on every port (comchip_uring.h)
+//     epoll     edge-triggered readiness, then read() (comchip_reactor.h)
+// Both take ownership of configured port fds, decode them with a per-port
+// stream decoder and deliver ComchipStatusEvent batches (comchip_event.h).
+// COMCHIP_INGEST_AUTO picks io_uring and falls back to epoll at runtime when
+// the kernel does not offer it (too old, disabled by sysctl or seccomp, or
+// not enough locked memory for the registered buffers).
+
+#ifndef COMCHIP_INGEST_H
+#define COMCHIP_INGEST_H
+
+#include "comchip_reactor.h"
+#include "comchip_uring.h"
+
+typedef enum {
+    COMCHIP_INGEST_AUTO,
+    COMCHIP_INGEST_URING,
+    COMCHIP_INGEST_EPOLL
+} ComchipIngestKind;
+
+typedef struct {
+    const char* name;
+    int32_t (*add)(void* impl, int fd, uint8_t layout_len);
+    void    (*remove)(void* impl, uint32_t id);
+    int     (*run_once)(void* impl, int timeout_ms);
+    void    (*close)(void* impl);
+} ComchipIngestBackend;
+
+typedef struct {
+    const ComchipIngestBackend* backend;
+    union {
+        ComchipUring   uring;
+        ComchipReactor reactor;
+    } impl;
+} ComchipIngest;
+
+// --- Backend Tables ---
+static int32_t comchip_ingest_uring_add(void* impl, int fd, uint8_t layout_len) {
+    return comchip_uring_add((ComchipUring*)impl, fd, layout_len);
+}
+static void comchip_ingest_uring_remove(void* impl, uint32_t id) {
+    comchip_uring_remove((ComchipUring*)impl, id);
+}
+static int comchip_ingest_uring_run_once(void* impl, int timeout_ms) {
+    return comchip_uring_run_once((ComchipUring*)impl, timeout_ms);
+}
+static void comchip_ingest_uring_close(void* impl) {
+    comchip_uring_close((ComchipUring*)impl);
+}
+
+static int32_t comchip_ingest_epoll_add(void* impl, int fd, uint8_t layout_len) {
+    return comchip_reactor_add((ComchipReactor*)impl, fd, layout_len);
+}
+static void comchip_ingest_epoll_remove(void* impl, uint32_t id) {
+    comchip_reactor_remove((ComchipReactor*)impl, id);
+}
+static int comchip_ingest_epoll_run_once(void* impl, int timeout_ms) {
+    return comchip_reactor_run_once((ComchipReactor*)impl, timeout_ms);
+}
+static void comchip_ingest_epoll_close(void* impl) {
+    comchip_reactor_close((ComchipReactor*)impl);
+}
+
+static const ComchipIngestBackend comchip_ingest_uring_backend = {
+    "io_uring", comchip_ingest_uring_add, comchip_ingest_uring_remove,
+    comchip_ingest_uring_run_once, comchip_ingest_uring_close
+};
+
+static const ComchipIngestBackend comchip_ingest_epoll_backend = {
+    "epoll", comchip_ingest_epoll_add, comchip_ingest_epoll_remove,
+    comchip_ingest_epoll_run_once, comchip_ingest_epoll_close
+};
+
+// --- Setup ---
+// Returns 0, or -1 with errno set by the last backend tried.
+static inline int comchip_ingest_init(ComchipIngest* in, ComchipIngestKind kind, uint32_t ports_cap,
+                                      comchip_batch_cb on_batch, comchip_closed_cb on_closed, void* ctx) {
+    in->backend = NULL;
+    if (kind != COMCHIP_INGEST_EPOLL) {
+        if (comchip_uring_init(&in->impl.uring, ports_cap, on_batch, on_closed, ctx) == 0) {
+            in->backend = &comchip_ingest_uring_backend;
+            return 0;
+        }
+        if (kind == COMCHIP_INGEST_URING) {
+            return -1;
+        }
+    }
+    if (comchip_reactor_init(&in->impl.reactor, ports_cap, on_batch, on_closed, ctx) == 0) {
+        in->backend = &comchip_ingest_epoll_backend;
+        return 0;
+    }
+    return -1;
+}
+
+// --- Forwarders ---
+// Take ownership of a configured port fd; returns the port id or -1 (errno set)
+static inline int32_t comchip_ingest_add(ComchipIngest* in, int fd, uint8_t layout_len) {
+    return in->backend->add(&in->impl, fd, layout_len);
+}
+
+static inline void comchip_ingest_remove(ComchipIngest* in, uint32_t id) {
+    in->backend->remove(&in->impl, id);
+}
+
+// Frames delivered, or -1 with errno set
+static inline int comchip_ingest_run_once(ComchipIngest* in, int timeout_ms) {
+    return in->backend->run_once(&in->impl, timeout_ms);
+}
+
+static inline void comchip_ingest_close(ComchipIngest* in) {
+    in->backend->close(&in->impl);
+    in->backend = NULL;
+}
+
+#endif // COMCHIP_INGEST_H
@@ -0,0 +1,79 @@
+// --- COMChip Status Frame Layouts ---
+// One parser for both firmware generations of the 'Get Battery Status'
+// response: the 6-byte frame (com-4gm.c) and the 7-byte frame with the extra
+// Byte2 discharge status (com3-gm.c). The frame shape is described by a
+// ComchipStatusLayout. The generic parser is force-inlined, so each named
+// parser below is compiled with its layout as a constant: the data-byte loop
+// is fully unrolled and the Byte2 branch disappears from the 6-byte path.
+
+#ifndef COMCHIP_LAYOUT_H
+#define COMCHIP_LAYOUT_H
+
+#include "comchip.h"
+#include "comchip_result.h"
+
+typedef struct {
+    uint8_t frame_len; // SYNC through checksum
+    bool    has_byte2; // Byte2 (discharge status) follows the voltage bytes
+} ComchipStatusLayout;
+
+#define COMCHIP_LAYOUT_STATUS6 ((ComchipStatusLayout){ COMCHIP_STATUS_FRAME_LEN, false })
+#define COMCHIP_LAYOUT_STATUS7 ((ComchipStatusLayout){ COMCHIP_STATUS_FRAME_LEN_BYTE2, true })
+
+// Largest frame any layout can describe
+#define COMCHIP_MAX_STATUS_FRAME_LEN COMCHIP_STATUS_FRAME_LEN_BYTE2
+
+#define COMCHIP_ALWAYS_INLINE inline __attribute__((always_inline))
+
+// Checksum over CID + data bytes, unrolled for the layout's constant length
+static COMCHIP_ALWAYS_INLINE uint8_t comchip_layout_checksum(const uint8_t* frame, const ComchipStatusLayout layout) {
+    return comchip_frame_checksum(frame, layout.frame_len);
+}
+
+// Decode the fields of a frame that already passed validation
+static COMCHIP_ALWAYS_INLINE void comchip_layout_decode(const uint8_t* frame, const ComchipStatusLayout layout,
+                                                        BatteryStatusData* out_data) {
+    comchip_decode_status_frame(frame, out_data);
+    if (layout.has_byte2) {
+        out_data->has_discharge_status = true;
+        out_data->discharge_status = (uint8_t)comchip_status_resp7_discharge_status(frame);
+    }
+}
+
+// --- Generic Parser (specialized per layout by inlining) ---
+static COMCHIP_ALWAYS_INLINE ComchipResult comchip_parse_status_layout(const uint8_t* packet, uint16_t packet_len,
+                                                                       const ComchipStatusLayout layout,
+                                                                       BatteryStatusData* out_data) {
+    // 1-4. Frame size, SYNC, CID and checksum, as declared in the schema
+    ComchipResult result = comchip_frame_validate(packet, packet_len, COMCHIP_CID_GET_STATUS_RESP, layout.frame_len);
+    if (result.error != COMCHIP_OK) {
+        return result;
+    }
+
+    // 5. Extract voltage, status flags and Byte2
+    comchip_layout_decode(packet, layout, out_data);
+    return comchip_result(COMCHIP_OK, 0, 0);
+}
+
+// --- Per-Layout Parsers ---
+static inline ComchipResult comchip_parse_status6(const uint8_t* packet, uint16_t packet_len, BatteryStatusData* out_data) {
+    return comchip_parse_status_layout(packet, packet_len, COMCHIP_LAYOUT_STATUS6, out_data);
+}
+
+static inline ComchipResult comchip_parse_status7(const uint8_t* packet, uint16_t packet_len, BatteryStatusData* out_data) {
+    return comchip_parse_status_layout(packet, packet_len, COMCHIP_LAYOUT_STATUS7, out_data);
+}
+
+// Mixed fleet entry point: the frame length picks the specialized parser
+static inline ComchipResult comchip_parse_status_any(const uint8_t* packet, uint16_t packet_len, BatteryStatusData* out_data) {
+    switch (packet_len) {
+    case COMCHIP_STATUS_FRAME_LEN:
+        return comchip_parse_status6(packet, packet_len, out_data);
+    case COMCHIP_STATUS_FRAME_LEN_BYTE2:
+        return comchip_parse_status7(packet, packet_len, out_data);
+    default:
+        return comchip_result(COMCHIP_ERR_FRAME_SIZE, COMCHIP_STATUS_FRAME_LEN, packet_len);
+    }
+}
+
+#endif // COMCHIP_LAYOUT_H
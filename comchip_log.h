@@ -0,0 +1,132 @@
+// --- COMChip Diagnostics Sink ---
+// Optional, buffered and rate-limited text output for ComchipResult values.
+// Messages are formatted into a local buffer and written with one fwrite when
+// it fills or on comchip_log_flush(). At most max_per_sec messages are kept
+// per one-second window; the rest are counted and reported as one line.
+// A sink is not thread safe: give each decode thread its own.
+
+#ifndef COMCHIP_LOG_H
+#define COMCHIP_LOG_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <time.h>
+
+#include "comchip_result.h"
+
+#define COMCHIP_LOG_BUF_SIZE 4096
+
+typedef struct {
+    FILE*    out;
+    char     buf[COMCHIP_LOG_BUF_SIZE];
+    size_t   used;
+
+    bool     log_success;    // Also report "Packet verified successfully!"
+    uint32_t max_per_sec;    // 0 = unlimited
+    uint64_t window_start_ns;
+    uint32_t in_window;
+    uint64_t suppressed;
+} ComchipLog;
+
+static inline uint64_t comchip_log_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static inline void comchip_log_init(ComchipLog* log, FILE* out, uint32_t max_per_sec, bool log_success) {
+    log->out = out;
+    log->used = 0;
+    log->log_success = log_success;
+    log->max_per_sec = max_per_sec;
+    log->window_start_ns = comchip_log_now_ns();
+    log->in_window = 0;
+    log->suppressed = 0;
+}
+
+// Write out the buffer as it is
+static inline void comchip_log_write(ComchipLog* log) {
+    if (log->used > 0) {
+        fwrite(log->buf, 1, log->used, log->out);
+        log->used = 0;
+    }
+    fflush(log->out);
+}
+
+// Append one formatted line, writing the buffer out first if it might not fit
+static inline void comchip_log_append(ComchipLog* log, const char* fmt, ...) {
+    if (log->used > COMCHIP_LOG_BUF_SIZE - 256) {
+        comchip_log_write(log);
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(log->buf + log->used, COMCHIP_LOG_BUF_SIZE - log->used, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        size_t room = COMCHIP_LOG_BUF_SIZE - log->used - 1;
+        log->used += (size_t)n < room ? (size_t)n : room;
+    }
+}
+
+// Returns false when this message falls over the per-second limit
+static inline bool comchip_log_admit(ComchipLog* log) {
+    if (log->max_per_sec == 0) {
+        return true;
+    }
+    uint64_t now = comchip_log_now_ns();
+    if (now - log->window_start_ns >= 1000000000ull) {
+        if (log->suppressed > 0) {
+            comchip_log_append(log, "(%llu messages suppressed)\n", (unsigned long long)log->suppressed);
+        }
+        log->window_start_ns = now;
+        log->in_window = 0;
+        log->suppressed = 0;
+    }
+    if (log->in_window >= log->max_per_sec) {
+        log->suppressed++;
+        return false;
+    }
+    log->in_window++;
+    return true;
+}
+
+// Write out everything so far, including the count of messages suppressed
+// in the current window (e.g. at shutdown, when no next window will report it)
+static inline void comchip_log_flush(ComchipLog* log) {
+    if (log->suppressed > 0) {
+        comchip_log_append(log, "(%llu messages suppressed)\n", (unsigned long long)log->suppressed);
+        log->suppressed = 0;
+    }
+    comchip_log_write(log);
+}
+
+// --- Report a Decode Result ---
+static inline void comchip_log_result(ComchipLog* log, ComchipResult r) {
+    if (r.error == COMCHIP_OK && !log->log_success) {
+        return;
+    }
+    if (!comchip_log_admit(log)) {
+        return;
+    }
+
+    switch (r.error) {
+    case COMCHIP_OK:
+        comchip_log_append(log, "Packet verified successfully!\n");
+        break;
+    case COMCHIP_ERR_FRAME_SIZE:
+        comchip_log_append(log, "Error: Invalid frame size. Expected %u bytes, got %u.\n", r.expected, r.got);
+        break;
+    case COMCHIP_ERR_SYNC:
+        comchip_log_append(log, "Error: Invalid SYNC byte. Expected 0x%02X, got 0x%02X.\n", r.expected, r.got);
+        break;
+    case COMCHIP_ERR_CID:
+        comchip_log_append(log, "Error: Invalid CID. Expected 0x%02X, got 0x%02X.\n", r.expected, r.got);
+        break;
+    case COMCHIP_ERR_CHECKSUM:
+        comchip_log_append(log, "Error: Checksum mismatch. Calculated 0x%02X, Received 0x%02X.\n", r.expected, r.got);
+        break;
+    }
+}
+
+#endif // COMCHIP_LOG_H
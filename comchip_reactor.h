@@ -0,0 +1,229 @@
+// --- COMChip Event Loop (epoll) ---
+// One thread, one epoll instance, many ports. Each port is a ComchipPort
+// (serial device or pty, see comchip_serial.h) with its own stream decoder.
+// Ports are registered edge-triggered: a readiness event is reported once
+// per arrival, the port is put on a ready list, and the loop drains ready
+// ports round-robin with a fixed read budget each. A port that still has
+// data after its budget stays on the list for the next round, so one chatty
+// link cannot starve the others, and the loop only calls epoll_wait() again
+// without a timeout while the list is non-empty.
+//
+// Decoded frames are not handed out one by one: they are collected as
+// ComchipStatusEvent entries (see comchip_event.h) and delivered to the
+// batch callback when the batch fills up and at the end of every loop
+// iteration.
+
+#ifndef COMCHIP_REACTOR_H
+#define COMCHIP_REACTOR_H
+
+#include <stdlib.h>
+#include <sys/epoll.h>
+
+#include "comchip_event.h"
+#include "comchip_serial.h"
+
+#define COMCHIP_REACTOR_READ_BUDGET 1024 // Bytes per port per round
+#define COMCHIP_REACTOR_EVENTS      256  // epoll events fetched per epoll_wait()
+
+typedef struct ComchipReactor ComchipReactor;
+
+typedef struct {
+    ComchipPort     port;
+    ComchipReactor* reactor;
+    uint32_t        id;
+    bool            active;
+    bool            queued; // On the ready list
+} ComchipReactorPort;
+
+struct ComchipReactor {
+    int                 epfd;
+    ComchipReactorPort* ports;
+    uint32_t            ports_cap;
+
+    uint32_t* free_ids; // Stack of unused port ids
+    uint32_t  free_count;
+
+    uint32_t* ready;    // Ring of port ids with data left to read
+    uint32_t  ready_head;
+    uint32_t  ready_count;
+
+    ComchipEventBatch out;
+
+    // Counters for diagnostics
+    uint64_t wakeups;    // epoll_wait() calls that returned events
+    uint64_t rounds;     // Passes over the ready list
+    uint64_t requeues;   // Ports that used up their budget
+};
+
+// --- Setup ---
+// Returns 0, or -1 with errno set.
+static inline int comchip_reactor_init(ComchipReactor* r, uint32_t ports_cap, comchip_batch_cb on_batch,
+                                       comchip_closed_cb on_closed, void* ctx) {
+    memset(r, 0, sizeof(*r));
+    r->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (r->epfd < 0) {
+        return -1;
+    }
+    r->ports = (ComchipReactorPort*)calloc(ports_cap, sizeof(*r->ports));
+    r->free_ids = (uint32_t*)malloc(ports_cap * sizeof(uint32_t));
+    r->ready = (uint32_t*)malloc(ports_cap * sizeof(uint32_t));
+    if (!r->ports || !r->free_ids || !r->ready) {
+        free(r->ports);
+        free(r->free_ids);
+        free(r->ready);
+        close(r->epfd);
+        errno = ENOMEM;
+        return -1;
+    }
+
+    r->ports_cap = ports_cap;
+    for (uint32_t i = 0; i < ports_cap; i++) {
+        r->free_ids[i] = ports_cap - 1 - i; // Hand out low ids first
+    }
+    r->free_count = ports_cap;
+    comchip_event_batch_init(&r->out, on_batch, on_closed, ctx);
+    return 0;
+}
+
+// Closes the epoll instance and every port fd still registered
+static inline void comchip_reactor_close(ComchipReactor* r) {
+    for (uint32_t i = 0; i < r->ports_cap; i++) {
+        if (r->ports[i].active) {
+            close(r->ports[i].port.fd);
+        }
+    }
+    close(r->epfd);
+    free(r->ports);
+    free(r->free_ids);
+    free(r->ready);
+    memset(r, 0, sizeof(*r));
+    r->epfd = -1;
+}
+
+static inline void comchip_reactor_on_frame(void* ctx, const BatteryStatusData* data) {
+    ComchipReactorPort* rp = (ComchipReactorPort*)ctx;
+    comchip_event_batch_push(&rp->reactor->out, rp->id, data);
+}
+
+static inline void comchip_reactor_mark_ready(ComchipReactor* r, uint32_t id) {
+    ComchipReactorPort* rp = &r->ports[id];
+    if (rp->active && !rp->queued) {
+        rp->queued = true;
+        r->ready[(r->ready_head + r->ready_count++) % r->ports_cap] = id;
+    }
+}
+
+// Take ownership of a configured, non-blocking fd (see comchip_serial_open()).
+// layout_len is the port's status frame length, or 0 to detect it.
+// Returns the port id, or -1 with errno set.
+static inline int32_t comchip_reactor_add(ComchipReactor* r, int fd, uint8_t layout_len) {
+    if (r->free_count == 0) {
+        errno = ENOSPC;
+        return -1;
+    }
+    uint32_t id = r->free_ids[r->free_count - 1];
+    ComchipReactorPort* rp = &r->ports[id];
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLET;
+    ev.data.u32 = id;
+    if (epoll_ctl(r->epfd, EPOLL_CTL_ADD, fd, &ev) < 0) {
+        return -1;
+    }
+
+    r->free_count--;
+    comchip_port_init(&rp->port, fd, comchip_reactor_on_frame, rp);
+    if (layout_len) {
+        comchip_stream_set_layout(&rp->port.stream, layout_len);
+    }
+    rp->reactor = r;
+    rp->id = id;
+    rp->active = true; // queued is left alone: a stale ring entry from a removed port is reused
+
+    // Bytes that arrived before registration produce no edge; look once
+    comchip_reactor_mark_ready(r, id);
+    return (int32_t)id;
+}
+
+// Unregister and close a port. A queued entry for it is skipped later.
+static inline void comchip_reactor_remove(ComchipReactor* r, uint32_t id) {
+    ComchipReactorPort* rp = &r->ports[id];
+    if (!rp->active) {
+        return;
+    }
+    epoll_ctl(r->epfd, EPOLL_CTL_DEL, rp->port.fd, NULL);
+    close(rp->port.fd);
+    rp->active = false;
+    r->free_ids[r->free_count++] = id;
+}
+
+// Drain every port on the ready list once. Ports that used up their budget
+// go to the back of the list.
+static inline void comchip_reactor_round(ComchipReactor* r) {
+    uint32_t n = r->ready_count;
+    r->rounds++;
+
+    for (uint32_t k = 0; k < n; k++) {
+        uint32_t id = r->ready[r->ready_head];
+        r->ready_head = (r->ready_head + 1) % r->ports_cap;
+        r->ready_count--;
+
+        ComchipReactorPort* rp = &r->ports[id];
+        if (!rp->queued) {
+            continue;
+        }
+        rp->queued = false;
+        if (!rp->active) {
+            continue; // Removed while queued
+        }
+
+        ComchipPortState state = comchip_port_drain(&rp->port, COMCHIP_REACTOR_READ_BUDGET, NULL);
+        if (state == COMCHIP_PORT_MORE) {
+            r->requeues++;
+            comchip_reactor_mark_ready(r, id);
+        } else if (state == COMCHIP_PORT_CLOSED) {
+            comchip_reactor_remove(r, id);
+            comchip_event_batch_closed(&r->out, id);
+        }
+    }
+}
+
+// --- Run ---
+// Wait up to timeout_ms for readiness (not at all while ports still have
+// data queued), drain one round and deliver the batch.
+// Returns the number of frames delivered, or -1 with errno set.
+static inline int comchip_reactor_run_once(ComchipReactor* r, int timeout_ms) {
+    struct epoll_event events[COMCHIP_REACTOR_EVENTS];
+    uint64_t frames_before = r->out.frames;
+
+    int n = epoll_wait(r->epfd, events, COMCHIP_REACTOR_EVENTS, r->ready_count ? 0 : timeout_ms);
+    if (n < 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+        n = 0;
+    }
+    if (n > 0) {
+        r->wakeups++;
+    }
+    for (int i = 0; i < n; i++) {
+        comchip_reactor_mark_ready(r, events[i].data.u32);
+    }
+
+    if (r->ready_count) {
+        comchip_reactor_round(r);
+    }
+    comchip_event_batch_flush(&r->out);
+    return (int)(r->out.frames - frames_before);
+}
+
+// Queue every port for one drain regardless of readiness. With VMIN > 1 a
+// few bytes below VMIN (noise, a cut-off frame) raise no event; calling this
+// from a slow periodic timer picks them up.
+static inline void comchip_reactor_sweep(ComchipReactor* r) {
+    for (uint32_t id = 0; id < r->ports_cap; id++) {
+        comchip_reactor_mark_ready(r, id);
+    }
+}
+
+#endif // COMCHIP_REACTOR_H
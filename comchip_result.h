@@ -0,0 +1,41 @@
+// --- COMChip Decode Result Codes ---
+// Decoders report what went wrong through a small result struct instead of
+// printing, so they do no I/O. Turning a result into text is left to the
+// caller, e.g. through the rate-limited sink in comchip_log.h.
+
+#ifndef COMCHIP_RESULT_H
+#define COMCHIP_RESULT_H
+
+#include <stdint.h>
+
+typedef enum {
+    COMCHIP_OK = 0,
+    COMCHIP_ERR_FRAME_SIZE, // expected / got: frame length in bytes
+    COMCHIP_ERR_SYNC,       // expected / got: SYNC byte
+    COMCHIP_ERR_CID,        // expected / got: Command ID
+    COMCHIP_ERR_CHECKSUM,   // expected / got: calculated / received checksum
+} ComchipError;
+
+typedef struct {
+    ComchipError error;
+    uint16_t     expected; // Value the decoder was looking for
+    uint16_t     got;      // Offending value found in the frame
+} ComchipResult;
+
+static inline ComchipResult comchip_result(ComchipError error, uint16_t expected, uint16_t got) {
+    ComchipResult r = { error, expected, got };
+    return r;
+}
+
+static inline const char* comchip_error_str(ComchipError error) {
+    switch (error) {
+    case COMCHIP_OK:             return "OK";
+    case COMCHIP_ERR_FRAME_SIZE: return "Invalid frame size";
+    case COMCHIP_ERR_SYNC:       return "Invalid SYNC byte";
+    case COMCHIP_ERR_CID:        return "Invalid CID";
+    case COMCHIP_ERR_CHECKSUM:   return "Checksum mismatch";
+    }
+    return "Unknown error";
+}
+
+#endif // COMCHIP_RESULT_H
@@ -0,0 +1,184 @@
+// --- COMChip SPSC Byte Ring ---
+// Lock-free single-producer / single-consumer ring of raw received bytes.
+// The I/O thread read()s straight into the ring and the decode thread feeds
+// the bytes to its ComchipStream in place, so a slow decoder only fills the
+// ring instead of stalling the serial reads.
+//
+// Both sides work on contiguous spans: write_span() hands the producer the
+// free bytes up to the end of the buffer, read_span() hands the consumer the
+// filled bytes up to the end of the buffer, and each side commits what it
+// used. A frame that wraps around the end arrives as two spans; the stream
+// decoder already carries split frames over between chunks.
+//
+// The producer's and the consumer's index each sit on their own cache line,
+// next to that side's cached copy of the other index, so the two threads only
+// touch each other's line when the cached view runs out.
+
+#ifndef COMCHIP_RING_H
+#define COMCHIP_RING_H
+
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "comchip_stream.h"
+
+#define COMCHIP_CACHE_LINE      64
+#define COMCHIP_HUGE_PAGE_SIZE  (2u << 20)
+
+#define COMCHIP_RING_HUGE_PAGES (1u << 0) // Back the buffer with huge pages
+
+typedef struct {
+    // Producer side
+    _Alignas(COMCHIP_CACHE_LINE) size_t tail; // Next byte to write (free-running)
+    size_t   head_cache;                      // Producer's last view of head
+    size_t   high_water;                      // Most bytes ever held
+    uint64_t full;                            // write_span() found no room
+
+    // Consumer side
+    _Alignas(COMCHIP_CACHE_LINE) size_t head; // Next byte to read (free-running)
+    size_t tail_cache;                        // Consumer's last view of tail
+
+    // Read-only after init
+    _Alignas(COMCHIP_CACHE_LINE) uint8_t* buf;
+    size_t cap;     // Power of two
+    size_t map_len;
+    bool   huge;    // Backed by MAP_HUGETLB pages
+} ComchipRing;
+
+// --- Setup ---
+// capacity is rounded up to a power of two (and to a huge page when asked
+// for). With COMCHIP_RING_HUGE_PAGES the buffer comes from MAP_HUGETLB if the
+// system has huge pages reserved, otherwise from normal pages with
+// transparent huge pages requested. Returns 0, or -1 with errno set.
+static inline int comchip_ring_init(ComchipRing* r, size_t capacity, unsigned flags) {
+    memset(r, 0, sizeof(*r));
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t min = flags & COMCHIP_RING_HUGE_PAGES ? COMCHIP_HUGE_PAGE_SIZE : page;
+    size_t cap = min;
+    while (cap < capacity) {
+        cap <<= 1;
+    }
+
+    void* p = MAP_FAILED;
+    if (flags & COMCHIP_RING_HUGE_PAGES) {
+        p = mmap(NULL, cap, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        r->huge = p != MAP_FAILED;
+    }
+    if (p == MAP_FAILED) {
+        p = mmap(NULL, cap, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) {
+            return -1;
+        }
+        if (flags & COMCHIP_RING_HUGE_PAGES) {
+            madvise(p, cap, MADV_HUGEPAGE); // Best effort
+        }
+    }
+
+    r->buf = (uint8_t*)p;
+    r->cap = cap;
+    r->map_len = cap;
+    return 0;
+}
+
+static inline void comchip_ring_free(ComchipRing* r) {
+    if (r->buf) {
+        munmap(r->buf, r->map_len);
+    }
+    memset(r, 0, sizeof(*r));
+}
+
+// --- Producer ---
+// Free bytes available contiguously at the write position (0 when full).
+static inline uint8_t* comchip_ring_write_span(ComchipRing* r, size_t* avail) {
+    size_t tail = r->tail;
+    size_t free_bytes = r->cap - (tail - r->head_cache);
+    if (free_bytes == 0) {
+        r->head_cache = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        free_bytes = r->cap - (tail - r->head_cache);
+        if (free_bytes == 0) {
+            r->full++;
+            *avail = 0;
+            return NULL;
+        }
+    }
+
+    size_t offset = tail & (r->cap - 1);
+    size_t to_end = r->cap - offset;
+    *avail = free_bytes < to_end ? free_bytes : to_end;
+    return r->buf + offset;
+}
+
+// Publish n bytes written into the last write span
+static inline void comchip_ring_write_commit(ComchipRing* r, size_t n) {
+    size_t tail = r->tail + n;
+    __atomic_store_n(&r->tail, tail, __ATOMIC_RELEASE);
+
+    // The cached view never under-counts the fill level, so head is only
+    // loaded when the ring may hold more than ever before
+    if (tail - r->head_cache > r->high_water) {
+        r->head_cache = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+        if (tail - r->head_cache > r->high_water) {
+            r->high_water = tail - r->head_cache;
+        }
+    }
+}
+
+// --- Consumer ---
+// Filled bytes available contiguously at the read position (0 when empty).
+static inline const uint8_t* comchip_ring_read_span(ComchipRing* r, size_t* avail) {
+    size_t head = r->head;
+    size_t filled = r->tail_cache - head;
+    if (filled == 0) {
+        r->tail_cache = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+        filled = r->tail_cache - head;
+        if (filled == 0) {
+            *avail = 0;
+            return NULL;
+        }
+    }
+
+    size_t offset = head & (r->cap - 1);
+    size_t to_end = r->cap - offset;
+    *avail = filled < to_end ? filled : to_end;
+    return r->buf + offset;
+}
+
+// Release n bytes of the last read span back to the producer
+static inline void comchip_ring_read_commit(ComchipRing* r, size_t n) {
+    __atomic_store_n(&r->head, r->head + n, __ATOMIC_RELEASE);
+}
+
+// --- COMChip Helpers ---
+// I/O thread: one read() straight into the ring. Returns what read() returned,
+// or -1 with errno = ENOBUFS when the ring is full.
+static inline ssize_t comchip_ring_read_fd(ComchipRing* r, int fd) {
+    size_t avail;
+    uint8_t* span = comchip_ring_write_span(r, &avail);
+    if (!span) {
+        errno = ENOBUFS;
+        return -1;
+    }
+    ssize_t n = read(fd, span, avail);
+    if (n > 0) {
+        comchip_ring_write_commit(r, (size_t)n);
+    }
+    return n;
+}
+
+// Decode thread: feed everything currently in the ring to a stream decoder,
+// in place. Returns the frames decoded.
+static inline size_t comchip_ring_decode(ComchipRing* r, ComchipStream* s) {
+    size_t frames = 0;
+    size_t avail;
+    const uint8_t* span;
+    while ((span = comchip_ring_read_span(r, &avail)) != NULL) {
+        frames += comchip_stream_feed(s, span, avail);
+        comchip_ring_read_commit(r, avail);
+    }
+    return frames;
+}
+
+#endif // COMCHIP_RING_H
@@ -0,0 +1,265 @@
+// --- COMChip Windowed Rollups ---
+// Min / max / mean / last voltage and alarm counts per 1 s, 1 min and 1 h
+// window, kept up to date sample by sample for every device and for every
+// group (rack, site, ...) the device belongs to. Each device and group holds
+// one open window per level; a sample is folded into each of them in O(1),
+// so nothing is ever recomputed from raw samples.
+//
+// Windows are aligned to multiples of their width on the sample clock
+// (CLOCK_MONOTONIC, like every other timestamp here). An open window has a
+// timer on a timing wheel, armed for its end plus a grace period for samples
+// still in flight; when it fires the window is handed to the callback and
+// closed, whether or not another sample came. A sample whose window was
+// already handed over is counted as late and left out of that level.
+//
+// The wheel is the caller's: pass the request engine's wheel and
+// comchip_engine_tick() drives the rollups as well.
+
+#ifndef COMCHIP_ROLLUP_H
+#define COMCHIP_ROLLUP_H
+
+#include <stdlib.h>
+#include <errno.h>
+
+#include "comchip.h"
+#include "comchip_wheel.h"
+
+#define COMCHIP_ROLLUP_LEVELS      3 // 1 s, 1 min, 1 h
+#define COMCHIP_ROLLUP_MAX_GROUPS  4 // Groups one device can be in
+#define COMCHIP_ROLLUP_GRACE_NS    (100 * COMCHIP_NS_PER_MS)
+
+typedef enum {
+    COMCHIP_ROLLUP_DEVICE,
+    COMCHIP_ROLLUP_GROUP
+} ComchipRollupKind;
+
+typedef struct {
+    uint64_t start_ns;      // [start_ns, end_ns)
+    uint64_t end_ns;
+    uint32_t count;
+    uint16_t min_mV;
+    uint16_t max_mV;
+    uint16_t last_mV;
+    uint64_t last_ns;
+    uint64_t sum_mV;
+    uint32_t errors;        // Samples reporting a battery error
+    uint32_t under_voltage; // Samples reporting under voltage
+} ComchipRollupWindow;
+
+static inline double comchip_rollup_mean(const ComchipRollupWindow* w) {
+    return w->count ? (double)w->sum_mV / w->count : 0.0;
+}
+
+typedef struct ComchipRollup ComchipRollup;
+
+// A closed window; id is the port id or the group id
+typedef void (*comchip_rollup_cb)(void* ctx, ComchipRollupKind kind, uint32_t id, unsigned level,
+                                  const ComchipRollupWindow* w);
+
+typedef struct {
+    ComchipRollup*      rollup;
+    uint32_t            id;
+    uint8_t             kind;
+    uint8_t             level;
+    bool                open;
+    uint64_t            closed_until; // Samples before this belong to windows already handed over
+    ComchipRollupWindow w;
+    ComchipTimer        timer;
+} ComchipRollupSlot;
+
+typedef struct {
+    ComchipRollupSlot levels[COMCHIP_ROLLUP_LEVELS];
+    uint32_t          groups[COMCHIP_ROLLUP_MAX_GROUPS]; // Devices only
+    uint8_t           group_count;
+} ComchipRollupKey;
+
+struct ComchipRollup {
+    ComchipWheel*     wheel;
+    ComchipRollupKey* devices; // Indexed by port id
+    uint32_t          devices_cap;
+    ComchipRollupKey* groups;  // Indexed by group id
+    uint32_t          groups_cap;
+
+    uint64_t width_ns[COMCHIP_ROLLUP_LEVELS];
+    uint64_t grace_ns;
+
+    comchip_rollup_cb on_window;
+    void*             ctx;
+
+    uint64_t samples;
+    uint64_t late;    // Per level and key
+    uint64_t windows; // Handed to on_window
+};
+
+static void comchip_rollup_on_timer(void* ctx, ComchipTimer* t);
+
+static inline void comchip_rollup_key_init(ComchipRollup* r, ComchipRollupKey* k, ComchipRollupKind kind,
+                                           uint32_t id) {
+    memset(k, 0, sizeof(*k));
+    for (unsigned l = 0; l < COMCHIP_ROLLUP_LEVELS; l++) {
+        ComchipRollupSlot* s = &k->levels[l];
+        s->rollup = r;
+        s->id = id;
+        s->kind = (uint8_t)kind;
+        s->level = (uint8_t)l;
+        comchip_timer_init(&s->timer, comchip_rollup_on_timer, s);
+    }
+}
+
+// Returns 0, or -1 with errno set
+static inline int comchip_rollup_init(ComchipRollup* r, ComchipWheel* wheel, uint32_t devices_cap,
+                                      uint32_t groups_cap, comchip_rollup_cb on_window, void* ctx) {
+    memset(r, 0, sizeof(*r));
+    r->devices = (ComchipRollupKey*)calloc(devices_cap, sizeof(*r->devices));
+    r->groups = (ComchipRollupKey*)calloc(groups_cap ? groups_cap : 1, sizeof(*r->groups));
+    if (!r->devices || !r->groups) {
+        free(r->devices);
+        free(r->groups);
+        errno = ENOMEM;
+        return -1;
+    }
+    r->wheel = wheel;
+    r->devices_cap = devices_cap;
+    r->groups_cap = groups_cap;
+    for (uint32_t i = 0; i < devices_cap; i++) {
+        comchip_rollup_key_init(r, &r->devices[i], COMCHIP_ROLLUP_DEVICE, i);
+    }
+    for (uint32_t i = 0; i < groups_cap; i++) {
+        comchip_rollup_key_init(r, &r->groups[i], COMCHIP_ROLLUP_GROUP, i);
+    }
+    r->width_ns[0] = COMCHIP_NS_PER_S;
+    r->width_ns[1] = 60 * COMCHIP_NS_PER_S;
+    r->width_ns[2] = 3600 * COMCHIP_NS_PER_S;
+    r->grace_ns = COMCHIP_ROLLUP_GRACE_NS;
+    r->on_window = on_window;
+    r->ctx = ctx;
+    return 0;
+}
+
+// Cancels the open windows' timers without handing them over
+static inline void comchip_rollup_free(ComchipRollup* r) {
+    for (uint32_t i = 0; i < r->devices_cap + r->groups_cap; i++) {
+        ComchipRollupKey* k = i < r->devices_cap ? &r->devices[i] : &r->groups[i - r->devices_cap];
+        for (unsigned l = 0; l < COMCHIP_ROLLUP_LEVELS; l++) {
+            comchip_timer_cancel(r->wheel, &k->levels[l].timer);
+        }
+    }
+    free(r->devices);
+    free(r->groups);
+    memset(r, 0, sizeof(*r));
+}
+
+// Put a device into a group. False if the group id is out of range or the
+// device is in COMCHIP_ROLLUP_MAX_GROUPS groups already.
+static inline bool comchip_rollup_join(ComchipRollup* r, uint32_t dev, uint32_t group) {
+    if (dev >= r->devices_cap || group >= r->groups_cap) {
+        return false;
+    }
+    ComchipRollupKey* k = &r->devices[dev];
+    for (uint8_t i = 0; i < k->group_count; i++) {
+        if (k->groups[i] == group) {
+            return true;
+        }
+    }
+    if (k->group_count == COMCHIP_ROLLUP_MAX_GROUPS) {
+        return false;
+    }
+    k->groups[k->group_count++] = group;
+    return true;
+}
+
+// --- Windows ---
+static inline void comchip_rollup_close(ComchipRollup* r, ComchipRollupSlot* s) {
+    comchip_timer_cancel(r->wheel, &s->timer);
+    s->open = false;
+    s->closed_until = s->w.end_ns;
+    r->windows++;
+    r->on_window(r->ctx, (ComchipRollupKind)s->kind, s->id, s->level, &s->w);
+}
+
+static void comchip_rollup_on_timer(void* ctx, ComchipTimer* t) {
+    ComchipRollupSlot* s = (ComchipRollupSlot*)ctx;
+    (void)t;
+    comchip_rollup_close(s->rollup, s);
+}
+
+static inline void comchip_rollup_fold(ComchipRollup* r, ComchipRollupSlot* s, uint64_t ts_ns,
+                                       const BatteryStatusData* data) {
+    if (ts_ns < s->closed_until) {
+        r->late++;
+        return;
+    }
+    uint64_t width = r->width_ns[s->level];
+    uint64_t start = ts_ns - ts_ns % width;
+    if (s->open && start != s->w.start_ns) {
+        if (start < s->w.start_ns) {
+            r->late++; // Older than the open window; its own was handed over
+            return;
+        }
+        comchip_rollup_close(r, s); // The next window started before the timer fired
+    }
+
+    ComchipRollupWindow* w = &s->w;
+    uint16_t mV = data->battery_voltage_mV;
+    if (!s->open) {
+        s->open = true;
+        memset(w, 0, sizeof(*w));
+        w->start_ns = start;
+        w->end_ns = start + width;
+        w->min_mV = mV;
+        w->max_mV = mV;
+        comchip_timer_arm(r->wheel, &s->timer, w->end_ns + r->grace_ns);
+    }
+    w->count++;
+    w->sum_mV += mV;
+    w->min_mV = mV < w->min_mV ? mV : w->min_mV;
+    w->max_mV = mV > w->max_mV ? mV : w->max_mV;
+    if (ts_ns >= w->last_ns) {
+        w->last_mV = mV;
+        w->last_ns = ts_ns;
+    }
+    w->errors += data->has_battery_error;
+    w->under_voltage += data->is_under_voltage;
+}
+
+// --- Samples ---
+// Fold one decoded sample of `dev` taken at ts_ns into the device's windows
+// and those of its groups
+static inline void comchip_rollup_add(ComchipRollup* r, uint32_t dev, uint64_t ts_ns, const BatteryStatusData* data) {
+    if (dev >= r->devices_cap) {
+        return;
+    }
+    ComchipRollupKey* k = &r->devices[dev];
+    r->samples++;
+    for (unsigned l = 0; l < COMCHIP_ROLLUP_LEVELS; l++) {
+        comchip_rollup_fold(r, &k->levels[l], ts_ns, data);
+    }
+    for (uint8_t g = 0; g < k->group_count; g++) {
+        ComchipRollupKey* gk = &r->groups[k->groups[g]];
+        for (unsigned l = 0; l < COMCHIP_ROLLUP_LEVELS; l++) {
+            comchip_rollup_fold(r, &gk->levels[l], ts_ns, data);
+        }
+    }
+}
+
+// Engine response callback (see comchip_engine.h); ctx is the rollup, and
+// the sample is timestamped on arrival
+static inline void comchip_rollup_on_response(void* ctx, uint32_t dev, const BatteryStatusData* data,
+                                              uint64_t rtt_ns) {
+    (void)rtt_ns;
+    comchip_rollup_add((ComchipRollup*)ctx, dev, comchip_now_ns(), data);
+}
+
+// Hand over every open window now, e.g. at shutdown
+static inline void comchip_rollup_flush(ComchipRollup* r) {
+    for (uint32_t i = 0; i < r->devices_cap + r->groups_cap; i++) {
+        ComchipRollupKey* k = i < r->devices_cap ? &r->devices[i] : &r->groups[i - r->devices_cap];
+        for (unsigned l = 0; l < COMCHIP_ROLLUP_LEVELS; l++) {
+            if (k->levels[l].open) {
+                comchip_rollup_close(r, &k->levels[l]);
+            }
+        }
+    }
+}
+
+#endif // COMCHIP_ROLLUP_H
@@ -0,0 +1,179 @@
+// --- COMChip Frame Candidate Scanner ---
+// Finds every position in a capture buffer where COMCHIP_SYNC_BYTE is
+// immediately followed by COMCHIP_CID_GET_STATUS_RESP. The SSE2 and AVX2
+// kernels compare 16/32 positions per step; the kernel is picked once at
+// runtime from CPUID, with a portable scalar fallback.
+
+#ifndef COMCHIP_SCAN_H
+#define COMCHIP_SCAN_H
+
+#include <string.h>
+
+#include "comchip.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define COMCHIP_SCAN_X86 1
+#endif
+
+// A kernel scans buf[from, len) and writes candidate offsets to out_pos.
+// It returns the number written and sets *resume_at to where the next call
+// should continue (len once the whole buffer has been scanned).
+typedef size_t (*comchip_scan_fn)(const uint8_t* buf, size_t len, size_t from,
+                                  size_t* out_pos, size_t out_cap, size_t* resume_at);
+
+// --- Scalar Kernel ---
+static inline size_t comchip_scan_scalar(const uint8_t* buf, size_t len, size_t from,
+                                         size_t* out_pos, size_t out_cap, size_t* resume_at) {
+    size_t n = 0;
+    size_t i = from;
+
+    while (i + 1 < len && n < out_cap) {
+        const uint8_t* p = (const uint8_t*)memchr(buf + i, COMCHIP_SYNC_BYTE, len - 1 - i);
+        if (!p) {
+            break;
+        }
+        i = (size_t)(p - buf);
+        if (buf[i + 1] == COMCHIP_CID_GET_STATUS_RESP) {
+            out_pos[n++] = i;
+        }
+        i++;
+    }
+    *resume_at = (n == out_cap && i + 1 < len) ? i : len;
+    return n;
+}
+
+#ifdef COMCHIP_SCAN_X86
+// Emit the set bits of a match mask; stops early if out_pos is full.
+static inline bool comchip_scan_emit(uint32_t mask, size_t base, size_t* out_pos,
+                                     size_t out_cap, size_t* n, size_t* resume_at) {
+    while (mask) {
+        if (*n == out_cap) {
+            *resume_at = base + (size_t)__builtin_ctz(mask);
+            return false;
+        }
+        out_pos[(*n)++] = base + (size_t)__builtin_ctz(mask);
+        mask &= mask - 1;
+    }
+    return true;
+}
+
+// --- SSE2 Kernel (16 positions per step) ---
+__attribute__((target("sse2")))
+static size_t comchip_scan_sse2(const uint8_t* buf, size_t len, size_t from,
+                                size_t* out_pos, size_t out_cap, size_t* resume_at) {
+    const __m128i sync = _mm_set1_epi8((char)COMCHIP_SYNC_BYTE);
+    const __m128i cid = _mm_set1_epi8((char)COMCHIP_CID_GET_STATUS_RESP);
+    size_t n = 0;
+    size_t i = from;
+
+    // Each step reads buf[i, i + 17), so stop one byte before the vector end
+    for (; i + 17 <= len; i += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(buf + i));
+        __m128i b = _mm_loadu_si128((const __m128i*)(buf + i + 1));
+        __m128i hit = _mm_and_si128(_mm_cmpeq_epi8(a, sync), _mm_cmpeq_epi8(b, cid));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(hit);
+        if (mask && !comchip_scan_emit(mask, i, out_pos, out_cap, &n, resume_at)) {
+            return n;
+        }
+    }
+
+    size_t tail_resume;
+    n += comchip_scan_scalar(buf, len, i, out_pos + n, out_cap - n, &tail_resume);
+    *resume_at = tail_resume;
+    return n;
+}
+
+// --- AVX2 Kernel (32 positions per step) ---
+__attribute__((target("avx2")))
+static size_t comchip_scan_avx2(const uint8_t* buf, size_t len, size_t from,
+                                size_t* out_pos, size_t out_cap, size_t* resume_at) {
+    const __m256i sync = _mm256_set1_epi8((char)COMCHIP_SYNC_BYTE);
+    const __m256i cid = _mm256_set1_epi8((char)COMCHIP_CID_GET_STATUS_RESP);
+    size_t n = 0;
+    size_t i = from;
+
+    for (; i + 33 <= len; i += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(buf + i));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(buf + i + 1));
+        __m256i hit = _mm256_and_si256(_mm256_cmpeq_epi8(a, sync), _mm256_cmpeq_epi8(b, cid));
+        uint32_t mask = (uint32_t)_mm256_movemask_epi8(hit);
+        if (mask && !comchip_scan_emit(mask, i, out_pos, out_cap, &n, resume_at)) {
+            return n;
+        }
+    }
+
+    size_t tail_resume;
+    n += comchip_scan_scalar(buf, len, i, out_pos + n, out_cap - n, &tail_resume);
+    *resume_at = tail_resume;
+    return n;
+}
+#endif // COMCHIP_SCAN_X86
+
+// --- Runtime Kernel Selection ---
+static comchip_scan_fn comchip_scan_impl;
+
+static inline comchip_scan_fn comchip_scan_select(void) {
+#ifdef COMCHIP_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return comchip_scan_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return comchip_scan_sse2;
+    }
+#endif
+    return comchip_scan_scalar;
+}
+
+static inline size_t comchip_scan_candidates(const uint8_t* buf, size_t len, size_t from,
+                                             size_t* out_pos, size_t out_cap, size_t* resume_at) {
+    if (!comchip_scan_impl) {
+        comchip_scan_impl = comchip_scan_select();
+    }
+    if (out_cap == 0 || from >= len) {
+        *resume_at = from < len ? from : len;
+        return 0;
+    }
+    return comchip_scan_impl(buf, len, from, out_pos, out_cap, resume_at);
+}
+
+// --- Scan and Validate a Whole Capture ---
+// Runs each candidate through the checksum check and decodes the good ones.
+// Candidates overlapping an already accepted frame are skipped.
+// Returns the number of frames decoded.
+static inline size_t comchip_scan_decode(const uint8_t* buf, size_t len,
+                                         void (*on_frame)(void* ctx, size_t offset, const BatteryStatusData* data),
+                                         void* ctx) {
+    size_t positions[1024];
+    size_t from = 0;
+    size_t next_free = 0; // First byte not covered by an accepted frame
+    size_t frames = 0;
+
+    while (from < len) {
+        size_t n = comchip_scan_candidates(buf, len, from, positions, 1024, &from);
+        if (n == 0) {
+            break;
+        }
+        for (size_t k = 0; k < n; k++) {
+            size_t pos = positions[k];
+            if (pos < next_free || pos + COMCHIP_STATUS_FRAME_LEN > len) {
+                continue;
+            }
+            const uint8_t* f = buf + pos;
+            if (calculate_checksum(f[1], &f[2], COMCHIP_STATUS_FRAME_LEN - 3) != f[COMCHIP_STATUS_FRAME_LEN - 1]) {
+                continue;
+            }
+            BatteryStatusData data;
+            comchip_decode_status_frame(f, &data);
+            if (on_frame) {
+                on_frame(ctx, pos, &data);
+            }
+            next_free = pos + COMCHIP_STATUS_FRAME_LEN;
+            frames++;
+        }
+    }
+    return frames;
+}
+
+#endif // COMCHIP_SCAN_H
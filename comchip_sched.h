@@ -0,0 +1,250 @@
+// --- COMChip Adaptive Poll Scheduler ---
+// Decides how often each battery is polled, from what its last responses
+// said:
+//     ALARM    battery error or under voltage      poll every alarm_ns
+//     FALLING  voltage dropping faster than         poll every falling_ns
+//              falling_mV_per_s
+//     STABLE   neither                              interval doubles per
+//                                                   response up to max_ns
+// A battery leaving STABLE drops straight to the faster interval; one that
+// settles works its way back up from base_ns.
+//
+// All batteries share one bandwidth budget in polls per second (e.g. from
+// comchip_sched_budget_for_baud()). The scheduler keeps the summed poll rate
+// of each class; while the total is over budget, STABLE and FALLING intervals
+// are stretched by the same factor so the total fits, and ALARM batteries
+// keep their rate unless they alone would use up 90% of the budget.
+//
+// Poll timers live on the request engine's timing wheel, so
+// comchip_engine_tick() drives them. Wiring: initialise the engine with
+// comchip_sched_on_response() and the scheduler as its callback context; the
+// scheduler forwards every response to its own callback.
+
+#ifndef COMCHIP_SCHED_H
+#define COMCHIP_SCHED_H
+
+#include "comchip_engine.h"
+
+#define COMCHIP_SCHED_ALARM_NS   (250 * COMCHIP_NS_PER_MS)
+#define COMCHIP_SCHED_FALLING_NS (1 * COMCHIP_NS_PER_S)
+#define COMCHIP_SCHED_BASE_NS    (2 * COMCHIP_NS_PER_S)
+#define COMCHIP_SCHED_MAX_NS     (30 * COMCHIP_NS_PER_S)
+#define COMCHIP_SCHED_FALLING_MV_PER_S 5.0 // Trend below minus this is FALLING
+#define COMCHIP_SCHED_ALARM_SHARE      0.9 // Budget ALARM batteries may use before they are stretched too
+#define COMCHIP_SCHED_UNLIMITED        0.0 // Budget: never stretch
+
+typedef enum {
+    COMCHIP_SCHED_STABLE,
+    COMCHIP_SCHED_FALLING,
+    COMCHIP_SCHED_ALARM
+} ComchipSchedClass;
+
+typedef struct ComchipScheduler ComchipScheduler;
+
+typedef struct {
+    ComchipScheduler* sched;
+    uint32_t          id;       // Port id, as in the engine
+    bool              active;
+    ComchipTimer      timer;    // Next poll
+    ComchipSchedClass cls;
+    uint64_t          interval_ns;  // Wanted interval, before any budget stretch
+    uint64_t          last_poll_ns;
+    uint64_t          next_poll_ns; // What the timer is armed for
+
+    // Voltage trend
+    bool     has_sample;
+    uint16_t last_mV;
+    uint64_t last_sample_ns;
+    double   trend_mV_per_s; // Smoothed over the last few responses
+
+    uint64_t polls;
+    uint64_t skipped;        // Due while the previous poll was still unanswered
+} ComchipSchedDevice;
+
+struct ComchipScheduler {
+    ComchipEngine*      engine;
+    ComchipSchedDevice* devices; // Indexed by port id
+    uint32_t            devices_cap;
+
+    double budget;       // Polls per second for all batteries together, 0 = unlimited
+    double rate[3];      // Summed wanted poll rate per class
+
+    uint64_t alarm_ns;
+    uint64_t falling_ns;
+    uint64_t base_ns;
+    uint64_t max_ns;
+    double   falling_mV_per_s;
+
+    comchip_response_cb on_response; // Forwarded responses
+    void*               ctx;
+};
+
+// Polls per second a link can carry at `baud` (8N1: 10 bits per byte) if
+// `utilization` of it goes to status polls: request plus the longer response.
+static inline double comchip_sched_budget_for_baud(uint32_t baud, double utilization) {
+    double bytes_per_poll = COMCHIP_STATUS_REQ_FRAME_LEN + COMCHIP_STATUS_RESP7_FRAME_LEN;
+    return baud / 10.0 / bytes_per_poll * utilization;
+}
+
+// budget is in polls per second, or COMCHIP_SCHED_UNLIMITED.
+// Returns 0, or -1 with errno set (EINVAL for a negative budget).
+static inline int comchip_sched_init(ComchipScheduler* s, ComchipEngine* engine, double budget,
+                                     comchip_response_cb on_response, void* ctx) {
+    memset(s, 0, sizeof(*s));
+    if (!(budget >= 0.0)) { // Also catches NaN
+        errno = EINVAL;
+        return -1;
+    }
+    s->devices = (ComchipSchedDevice*)calloc(engine->devices_cap, sizeof(*s->devices));
+    if (!s->devices) {
+        errno = ENOMEM;
+        return -1;
+    }
+    s->engine = engine;
+    s->devices_cap = engine->devices_cap;
+    s->budget = budget;
+    s->alarm_ns = COMCHIP_SCHED_ALARM_NS;
+    s->falling_ns = COMCHIP_SCHED_FALLING_NS;
+    s->base_ns = COMCHIP_SCHED_BASE_NS;
+    s->max_ns = COMCHIP_SCHED_MAX_NS;
+    s->falling_mV_per_s = COMCHIP_SCHED_FALLING_MV_PER_S;
+    s->on_response = on_response;
+    s->ctx = ctx;
+    return 0;
+}
+
+static inline void comchip_sched_free(ComchipScheduler* s) {
+    for (uint32_t i = 0; i < s->devices_cap; i++) {
+        comchip_timer_cancel(&s->engine->wheel, &s->devices[i].timer);
+    }
+    free(s->devices);
+    memset(s, 0, sizeof(*s));
+}
+
+// --- Budget ---
+// Factor the wanted interval of a class is stretched by to stay within budget
+static inline double comchip_sched_stretch(const ComchipScheduler* s, ComchipSchedClass cls) {
+    double alarm = s->rate[COMCHIP_SCHED_ALARM];
+    double other = s->rate[COMCHIP_SCHED_STABLE] + s->rate[COMCHIP_SCHED_FALLING];
+    double alarm_cap = s->budget * COMCHIP_SCHED_ALARM_SHARE;
+
+    if (s->budget == COMCHIP_SCHED_UNLIMITED) {
+        return 1.0;
+    }
+    if (cls == COMCHIP_SCHED_ALARM) {
+        return alarm > alarm_cap ? alarm / alarm_cap : 1.0;
+    }
+    double left = s->budget - (alarm < alarm_cap ? alarm : alarm_cap);
+    return other > left ? other / left : 1.0;
+}
+
+static inline uint64_t comchip_sched_effective_ns(const ComchipScheduler* s, const ComchipSchedDevice* d) {
+    return (uint64_t)(d->interval_ns * comchip_sched_stretch(s, d->cls));
+}
+
+static inline void comchip_sched_set(ComchipScheduler* s, ComchipSchedDevice* d, ComchipSchedClass cls,
+                                     uint64_t interval_ns) {
+    s->rate[d->cls] -= (double)COMCHIP_NS_PER_S / d->interval_ns;
+    d->cls = cls;
+    d->interval_ns = interval_ns;
+    s->rate[d->cls] += (double)COMCHIP_NS_PER_S / d->interval_ns;
+}
+
+// --- Polling ---
+// Stop scheduling polls for a device and give its rate back to the budget
+static inline void comchip_sched_remove(ComchipScheduler* s, uint32_t dev) {
+    if (dev >= s->devices_cap) {
+        return;
+    }
+    ComchipSchedDevice* d = &s->devices[dev];
+    if (!d->active) {
+        return;
+    }
+    comchip_timer_cancel(&s->engine->wheel, &d->timer);
+    s->rate[d->cls] -= (double)COMCHIP_NS_PER_S / d->interval_ns;
+    d->active = false;
+}
+
+// A device the engine no longer has attached (detached from on_failure or on
+// hang-up) is removed from the schedule instead of polled
+static void comchip_sched_on_timer(void* ctx, ComchipTimer* t) {
+    ComchipSchedDevice* d = (ComchipSchedDevice*)ctx;
+    ComchipScheduler* s = d->sched;
+    uint64_t now = comchip_now_ns();
+
+    // A battery that has not answered yet (or is being retried) gets no second poll stacked up
+    const ComchipDevice* ed = &s->engine->devices[d->id];
+    if (ed->pending == 0 && ed->inflight_count == 0) {
+        if (!comchip_engine_poll(s->engine, d->id, 1)) {
+            comchip_sched_remove(s, d->id);
+            return;
+        }
+        d->polls++;
+    } else {
+        d->skipped++;
+    }
+    d->last_poll_ns = now;
+    d->next_poll_ns = now + comchip_sched_effective_ns(s, d);
+    comchip_timer_arm(&s->engine->wheel, t, d->next_poll_ns);
+}
+
+// Start scheduling polls for an attached engine device; the first poll goes out on the next tick
+static inline bool comchip_sched_add(ComchipScheduler* s, uint32_t dev) {
+    if (dev >= s->devices_cap || s->devices[dev].active) {
+        return false;
+    }
+    ComchipSchedDevice* d = &s->devices[dev];
+    memset(d, 0, sizeof(*d));
+    d->sched = s;
+    d->id = dev;
+    d->active = true;
+    d->cls = COMCHIP_SCHED_STABLE;
+    d->interval_ns = s->base_ns;
+    s->rate[d->cls] += (double)COMCHIP_NS_PER_S / d->interval_ns;
+    comchip_timer_init(&d->timer, comchip_sched_on_timer, d);
+    d->next_poll_ns = comchip_now_ns();
+    comchip_timer_arm(&s->engine->wheel, &d->timer, d->next_poll_ns);
+    return true;
+}
+
+// --- Responses ---
+// Engine response callback; ctx is the scheduler
+static inline void comchip_sched_on_response(void* ctx, uint32_t dev, const BatteryStatusData* data, uint64_t rtt_ns) {
+    ComchipScheduler* s = (ComchipScheduler*)ctx;
+    ComchipSchedDevice* d = &s->devices[dev];
+
+    if (d->active) {
+        uint64_t now = comchip_now_ns();
+        if (d->has_sample && now > d->last_sample_ns) {
+            double slope = ((double)data->battery_voltage_mV - d->last_mV) * COMCHIP_NS_PER_S / (now - d->last_sample_ns);
+            d->trend_mV_per_s += (slope - d->trend_mV_per_s) / 4;
+        }
+        d->has_sample = true;
+        d->last_mV = data->battery_voltage_mV;
+        d->last_sample_ns = now;
+
+        if (data->has_battery_error || data->is_under_voltage) {
+            comchip_sched_set(s, d, COMCHIP_SCHED_ALARM, s->alarm_ns);
+        } else if (d->trend_mV_per_s < -s->falling_mV_per_s) {
+            comchip_sched_set(s, d, COMCHIP_SCHED_FALLING, s->falling_ns);
+        } else if (d->cls != COMCHIP_SCHED_STABLE) {
+            comchip_sched_set(s, d, COMCHIP_SCHED_STABLE, s->base_ns); // Settled: start over from base
+        } else {
+            uint64_t longer = d->interval_ns * 2;
+            comchip_sched_set(s, d, COMCHIP_SCHED_STABLE, longer < s->max_ns ? longer : s->max_ns);
+        }
+
+        // A battery that just turned critical moves to its new rate right
+        // away; a longer interval takes effect from the next poll
+        uint64_t due = d->last_poll_ns + comchip_sched_effective_ns(s, d);
+        if (due < d->next_poll_ns) {
+            d->next_poll_ns = due;
+            comchip_timer_arm(&s->engine->wheel, &d->timer, due);
+        }
+    }
+    if (s->on_response) {
+        s->on_response(s->ctx, dev, data, rtt_ns);
+    }
+}
+
+#endif // COMCHIP_SCHED_H
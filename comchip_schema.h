@@ -0,0 +1,150 @@
+// --- COMChip Protocol Schema ---
+// Every COMChip command is declared here once: its CID and frame length, the
+// fields inside its frame (offset, width, byte order) and the flag bits inside
+// those fields. Constants, field extractors and frame validators are generated
+// from these tables with X-macros, so a new response type is one table entry
+// and the example programs cannot drift apart. All generated functions are
+// static inline with constant offsets and compile down to plain byte loads.
+//
+// Every frame has the same envelope:
+//     SYNC (1) | CID (1) | data ... | Checksum (1)
+// and the checksum covers CID + data (see calculate_checksum()).
+
+#ifndef COMCHIP_SCHEMA_H
+#define COMCHIP_SCHEMA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "comchip_result.h"
+
+// --- Frame Envelope ---
+#define COMCHIP_SYNC_BYTE           0x55 // Expected SYNC byte for COMChip communication
+#define COMCHIP_SYNC_INDEX          0
+#define COMCHIP_CID_INDEX           1
+#define COMCHIP_DATA_INDEX          2    // First data byte
+#define COMCHIP_ENVELOPE_LEN        3    // SYNC + CID + Checksum
+
+// Command IDs for 'Get Battery Status'. A response CID is the request CID
+// with bit 7 set.
+#define COMCHIP_CID_GET_STATUS_REQ  0x01 // Request to COMChip
+#define COMCHIP_CID_GET_STATUS_RESP 0x81 // Response from COMChip
+
+// Bit masks for the Status Byte (Byte0 in the response data)
+#define STATUS_BIT_BATTERY_ERROR     (1 << 7) // Bit 7: 1 = Battery has error
+#define STATUS_BIT_UNDER_VOLTAGE     (1 << 6) // Bit 6: 1 = Under voltage detected
+#define STATUS_BIT_NOT_SUPPORTED     (1 << 5) // Bit 5: 1 = Battery not supported
+#define STATUS_BIT_NOT_DISCHARGEABLE (1 << 0) // Bit 0: 1 = Battery cannot be discharged
+
+// Byte order of multi-byte fields
+#define COMCHIP_BE 0 // HIGH byte first
+#define COMCHIP_LE 1 // LOW byte first
+
+// --- Commands ---
+// X(NAME, name, cid, frame_len)
+#define COMCHIP_COMMANDS(X) \
+    X(STATUS_REQ,   status_req,   COMCHIP_CID_GET_STATUS_REQ,  3) /* Request, no data */ \
+    X(STATUS_RESP,  status_resp,  COMCHIP_CID_GET_STATUS_RESP, 6) /* Without Byte2 */ \
+    X(STATUS_RESP7, status_resp7, COMCHIP_CID_GET_STATUS_RESP, 7) /* With Byte2 (discharge status) */
+
+// --- Fields ---
+// X(NAME, name, field, offset, width, byte_order)
+#define COMCHIP_STATUS_FIELDS(X, NAME, name) \
+    X(NAME, name, status_byte, 2, 1, COMCHIP_BE) /* Byte0: status flags */ \
+    X(NAME, name, voltage_mV,  3, 2, COMCHIP_BE) /* Battery voltage HIGH, LOW */
+
+#define COMCHIP_FIELDS(X) \
+    COMCHIP_STATUS_FIELDS(X, STATUS_RESP, status_resp) \
+    COMCHIP_STATUS_FIELDS(X, STATUS_RESP7, status_resp7) \
+    X(STATUS_RESP7, status_resp7, discharge_status, 5, 1, COMCHIP_BE) /* Byte2: discharged / not discharged */
+
+// --- Flags ---
+// X(name, field, flag, mask)
+#define COMCHIP_STATUS_FLAGS(X, name) \
+    X(name, status_byte, battery_error,     STATUS_BIT_BATTERY_ERROR) \
+    X(name, status_byte, under_voltage,     STATUS_BIT_UNDER_VOLTAGE) \
+    X(name, status_byte, not_supported,     STATUS_BIT_NOT_SUPPORTED) \
+    X(name, status_byte, not_dischargeable, STATUS_BIT_NOT_DISCHARGEABLE)
+
+#define COMCHIP_FLAGS(X) \
+    COMCHIP_STATUS_FLAGS(X, status_resp) \
+    COMCHIP_STATUS_FLAGS(X, status_resp7)
+
+// --- Generic Helpers (constant-folded at every call site) ---
+static inline __attribute__((always_inline)) uint32_t comchip_field_get(const uint8_t* frame, unsigned offset,
+                                                                        unsigned width, int byte_order) {
+    uint32_t value = 0;
+    for (unsigned i = 0; i < width; i++) {
+        unsigned byte = byte_order == COMCHIP_BE ? offset + i : offset + width - 1 - i;
+        value = (value << 8) | frame[byte];
+    }
+    return value;
+}
+
+// Checksum over CID + data bytes of a whole frame. Sum first and fold twice:
+// same result as the document's per-add fold for frames shorter than 256
+// bytes (see comchip_checksum.h). Unrolled when frame_len is a constant.
+static inline __attribute__((always_inline)) uint8_t comchip_frame_checksum(const uint8_t* frame, uint16_t frame_len) {
+    uint32_t sum = 0;
+    for (uint16_t i = COMCHIP_CID_INDEX; i < frame_len - 1; i++) {
+        sum += frame[i];
+    }
+    sum = (sum & 0xFFu) + (sum >> 8);
+    sum = (sum & 0xFFu) + (sum >> 8);
+    return (uint8_t)(~sum & 0xFFu);
+}
+
+// Length, SYNC, CID and checksum checks shared by every command
+static inline __attribute__((always_inline)) ComchipResult comchip_frame_validate(const uint8_t* frame, uint16_t len,
+                                                                                 uint8_t cid, uint16_t frame_len) {
+    if (len != frame_len) {
+        return comchip_result(COMCHIP_ERR_FRAME_SIZE, frame_len, len);
+    }
+    if (frame[COMCHIP_SYNC_INDEX] != COMCHIP_SYNC_BYTE) {
+        return comchip_result(COMCHIP_ERR_SYNC, COMCHIP_SYNC_BYTE, frame[COMCHIP_SYNC_INDEX]);
+    }
+    if (frame[COMCHIP_CID_INDEX] != cid) {
+        return comchip_result(COMCHIP_ERR_CID, cid, frame[COMCHIP_CID_INDEX]);
+    }
+
+    uint8_t calculated_cs = comchip_frame_checksum(frame, frame_len);
+    if (calculated_cs != frame[frame_len - 1]) {
+        return comchip_result(COMCHIP_ERR_CHECKSUM, calculated_cs, frame[frame_len - 1]);
+    }
+    return comchip_result(COMCHIP_OK, 0, 0);
+}
+
+// --- Generated: Command Constants ---
+// COMCHIP_<NAME>_CID, COMCHIP_<NAME>_FRAME_LEN
+#define COMCHIP_GEN_COMMAND_CONSTANTS(NAME, name, cid, frame_len) \
+    enum { COMCHIP_##NAME##_CID = (cid), COMCHIP_##NAME##_FRAME_LEN = (frame_len) }; \
+    _Static_assert((frame_len) >= COMCHIP_ENVELOPE_LEN && (frame_len) < 256, #name ": bad frame length");
+COMCHIP_COMMANDS(COMCHIP_GEN_COMMAND_CONSTANTS)
+
+// --- Generated: Validators ---
+// comchip_<name>_validate(frame, len)
+#define COMCHIP_GEN_VALIDATOR(NAME, name, cid, frame_len) \
+    static inline ComchipResult comchip_##name##_validate(const uint8_t* frame, uint16_t len) { \
+        return comchip_frame_validate(frame, len, (cid), (frame_len)); \
+    }
+COMCHIP_COMMANDS(COMCHIP_GEN_VALIDATOR)
+
+// --- Generated: Field Extractors ---
+// comchip_<name>_<field>(frame), checked at compile time to lie inside the data bytes
+#define COMCHIP_GEN_FIELD(NAME, name, field, offset, width, byte_order) \
+    _Static_assert((offset) >= COMCHIP_DATA_INDEX && (offset) + (width) <= COMCHIP_##NAME##_FRAME_LEN - 1 && \
+                   (width) >= 1 && (width) <= 4, #name "." #field ": outside the frame data"); \
+    static inline uint32_t comchip_##name##_##field(const uint8_t* frame) { \
+        return comchip_field_get(frame, (offset), (width), (byte_order)); \
+    }
+COMCHIP_FIELDS(COMCHIP_GEN_FIELD)
+
+// --- Generated: Flag Tests ---
+// comchip_<name>_<flag>(frame)
+#define COMCHIP_GEN_FLAG(name, field, flag, mask) \
+    static inline bool comchip_##name##_##flag(const uint8_t* frame) { \
+        return (comchip_##name##_##field(frame) & (uint32_t)(mask)) != 0; \
+    }
+COMCHIP_FLAGS(COMCHIP_GEN_FLAG)
+
+#endif // COMCHIP_SCHEMA_H
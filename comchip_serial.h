@@ -0,0 +1,168 @@
+// --- COMChip Serial Port Backend ---
+// Opens a COMChip link as a raw, non-blocking termios port and drains it
+// into a ComchipStream. Each port owns one receive buffer; read() lands in
+// it and the decoder validates frames in place, so bytes are not copied
+// between the kernel and the decoder.
+//
+// Batching: with VTIME = 0 the Linux tty layer only reports a port as
+// readable (poll/epoll) once VMIN bytes are queued, and a read() then returns
+// everything that is queued. Setting VMIN to one frame means a port wakes its
+// owner about once per response instead of once per byte, which is what
+// keeps hundreds of ports cheap on one thread. Bytes below VMIN (line noise,
+// a truncated frame) stay queued until more arrive or the port is drained
+// without waiting for readiness.
+//
+// A pseudo-terminal pair behaves like a serial port for all of this, so
+// comchip_pty_open() gives examples and tests a link they can write frames
+// into from the master side.
+
+#ifndef COMCHIP_SERIAL_H
+#define COMCHIP_SERIAL_H
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include <sys/ioctl.h>
+
+#include "comchip_stream.h"
+
+#define COMCHIP_PORT_RX_BUF   4096                     // Bytes read per read() at most
+#define COMCHIP_SERIAL_VMIN   COMCHIP_STATUS_FRAME_LEN // Wake once the shortest status frame is queued
+
+// Result of draining a port
+typedef enum {
+    COMCHIP_PORT_IDLE,   // Everything queued was read (read() would block)
+    COMCHIP_PORT_MORE,   // Read budget used up, data may still be queued
+    COMCHIP_PORT_CLOSED  // Hang-up, EOF or read error (errno is set)
+} ComchipPortState;
+
+typedef struct {
+    int           fd;
+    ComchipStream stream;
+    uint8_t       rx[COMCHIP_PORT_RX_BUF];
+
+    // Counters for link diagnostics
+    uint64_t reads;       // read() calls that returned data
+    uint64_t bytes_read;
+} ComchipPort;
+
+// --- Port Setup ---
+// Raw 8N1, no flow control, non-blocking. vmin/vtime as in termios(3).
+// Returns 0, or -1 with errno set.
+static inline int comchip_serial_configure(int fd, speed_t baud, uint8_t vmin, uint8_t vtime) {
+    struct termios tio;
+    if (tcgetattr(fd, &tio) < 0) {
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    tio.c_cc[VMIN] = vmin;
+    tio.c_cc[VTIME] = vtime;
+    if (cfsetispeed(&tio, baud) < 0 || cfsetospeed(&tio, baud) < 0) {
+        return -1;
+    }
+    if (tcsetattr(fd, TCSANOW, &tio) < 0) {
+        return -1;
+    }
+
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+        return -1;
+    }
+    return 0;
+}
+
+// Open and configure a serial device (e.g. "/dev/ttyUSB0", B9600).
+// Returns the fd, or -1 with errno set.
+static inline int comchip_serial_open(const char* path, speed_t baud, uint8_t vmin) {
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    if (comchip_serial_configure(fd, baud, vmin, 0) < 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    return fd;
+}
+
+// Pseudo-terminal stand-in for a serial link. The slave end is configured
+// like a real port and is what a ComchipPort reads; bytes written to the
+// master end arrive on it. Returns 0, or -1 with errno set.
+static inline int comchip_pty_open(int* master_fd, int* slave_fd, uint8_t vmin) {
+    int master = open("/dev/ptmx", O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (master < 0) {
+        return -1;
+    }
+
+    unsigned pty_num;
+    int unlock = 0;
+    char slave_path[32];
+    int slave = -1;
+    if (ioctl(master, TIOCSPTLCK, &unlock) == 0 && ioctl(master, TIOCGPTN, &pty_num) == 0) {
+        snprintf(slave_path, sizeof(slave_path), "/dev/pts/%u", pty_num);
+        slave = comchip_serial_open(slave_path, B115200, vmin);
+    }
+    if (slave < 0) {
+        int saved = errno;
+        close(master);
+        errno = saved;
+        return -1;
+    }
+
+    *master_fd = master;
+    *slave_fd = slave;
+    return 0;
+}
+
+// --- Ingestion ---
+static inline void comchip_port_init(ComchipPort* p, int fd, comchip_frame_cb on_frame, void* ctx) {
+    p->fd = fd;
+    comchip_stream_init(&p->stream, on_frame, ctx);
+    p->reads = 0;
+    p->bytes_read = 0;
+}
+
+// Read whatever is queued, up to `budget` bytes, and decode it. A port that
+// returns COMCHIP_PORT_MORE still has data and should be drained again after
+// the other ports had their turn. bytes_read may be NULL.
+static inline ComchipPortState comchip_port_drain(ComchipPort* p, size_t budget, size_t* bytes_read) {
+    size_t total = 0;
+    ComchipPortState state = COMCHIP_PORT_MORE;
+
+    while (total < budget) {
+        size_t want = budget - total < sizeof(p->rx) ? budget - total : sizeof(p->rx);
+        ssize_t n = read(p->fd, p->rx, want);
+        if (n > 0) {
+            p->reads++;
+            p->bytes_read += (uint64_t)n;
+            total += (size_t)n;
+            comchip_stream_feed(&p->stream, p->rx, (size_t)n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            state = COMCHIP_PORT_IDLE;
+        } else {
+            if (n == 0) {
+                errno = 0;
+            }
+            state = COMCHIP_PORT_CLOSED; // EOF, or EIO once the other end of a pty is gone
+        }
+        break;
+    }
+
+    if (bytes_read) {
+        *bytes_read = total;
+    }
+    return state;
+}
+
+#endif // COMCHIP_SERIAL_H
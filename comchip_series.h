@@ -0,0 +1,608 @@
+// --- COMChip Columnar Time-Series Store ---
+// Append-only history of every decoded voltage and status byte, one series
+// per device, stored by column instead of by row:
+//     timestamps  delta-of-delta, bit-packed
+//     voltage     delta-of-delta, bit-packed
+//     status      run-length encoded
+// Polls come at a steady rate and voltages drift slowly, so both deltas of
+// deltas are mostly within a few bits of zero, and the status byte changes
+// rarely: a sample costs around two bytes instead of a text log line.
+//
+// Samples collect raw in an active block that is sealed (encoded) when it
+// holds COMCHIP_SERIES_BLOCK_SAMPLES or when a sample crosses into the next
+// time partition, so a block never spans two partitions. Every block header
+// carries its time range, voltage min/max and the OR/AND of its status bytes:
+// a scan skips any block whose header rules out a match without decoding it.
+//
+// Bit packing works on groups of 128 values of one width, laid out as four
+// interleaved 32-bit lanes (value i in lane i % 4): all four lanes of a word
+// row unpack with the same shift, which the compiler turns into vector code.
+// A group whose values do not fit 32 bits is stored as raw 64-bit values.
+//
+// Sealed blocks are self-contained byte blobs. With a file attached they are
+// also appended to it as they are sealed, and comchip_series_load() maps
+// such a file back and scans its blocks in place.
+
+#ifndef COMCHIP_SERIES_H
+#define COMCHIP_SERIES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "comchip.h"
+#include "comchip_time.h"
+
+#define COMCHIP_SERIES_BLOCK_SAMPLES 1024
+#define COMCHIP_SERIES_GROUP         128                        // Values per bit-packed group
+#define COMCHIP_SERIES_GROUPS        (COMCHIP_SERIES_BLOCK_SAMPLES / COMCHIP_SERIES_GROUP)
+#define COMCHIP_SERIES_RAW64         64                         // Group width marker: raw 64-bit values
+#define COMCHIP_SERIES_PARTITION_NS  (3600 * COMCHIP_NS_PER_S)  // Blocks never span two hours
+#define COMCHIP_SERIES_BLOCK_MAGIC   0x31425343u                // "CSB1"
+
+// Largest column: first value and delta, widths, every group raw
+#define COMCHIP_SERIES_MAX_COLUMN (16 + COMCHIP_SERIES_GROUPS + COMCHIP_SERIES_BLOCK_SAMPLES * 8)
+#define COMCHIP_SERIES_MAX_BLOCK  (sizeof(ComchipSeriesBlock) + 2 * COMCHIP_SERIES_MAX_COLUMN + \
+                                   COMCHIP_SERIES_BLOCK_SAMPLES * 3 + 8)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t size;       // Whole block, header included, multiple of 8
+    uint16_t count;      // Samples
+    uint16_t runs;       // Status runs
+    uint8_t  status_or;  // OR and AND of every status byte
+    uint8_t  status_and;
+    uint16_t mV_min;
+    uint16_t mV_max;
+    uint16_t reserved;
+    uint32_t ts_len;     // Column bytes; the status column follows the voltage column
+    uint32_t mV_len;
+    uint64_t t_min;
+    uint64_t t_max;
+} ComchipSeriesBlock;
+
+_Static_assert(sizeof(ComchipSeriesBlock) == 48, "Series block header layout");
+
+static inline size_t comchip_series_pad8(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+// --- Bit Packing ---
+// 128 values of `b` bits (b <= 32) in 4 * b words, lane-interleaved
+static inline void comchip_bp_pack(const uint64_t* in, unsigned b, uint32_t* out) {
+    memset(out, 0, 16 * b);
+    for (unsigned k = 0; k < COMCHIP_SERIES_GROUP / 4; k++) {
+        unsigned bit = k * b, w = bit >> 5, s = bit & 31;
+        for (unsigned l = 0; l < 4; l++) {
+            uint32_t v = (uint32_t)in[k * 4 + l];
+            out[w * 4 + l] |= v << s;
+            if (s + b > 32) {
+                out[(w + 1) * 4 + l] |= v >> (32 - s);
+            }
+        }
+    }
+}
+
+static inline void comchip_bp_unpack(const uint32_t* in, unsigned b, uint32_t* out) {
+    if (b == 0) {
+        memset(out, 0, COMCHIP_SERIES_GROUP * sizeof(*out));
+        return;
+    }
+    uint32_t mask = b == 32 ? UINT32_MAX : (1u << b) - 1;
+    for (unsigned k = 0; k < COMCHIP_SERIES_GROUP / 4; k++) {
+        unsigned bit = k * b, w = bit >> 5, s = bit & 31;
+        if (s + b > 32) {
+            for (unsigned l = 0; l < 4; l++) {
+                out[k * 4 + l] = ((in[w * 4 + l] >> s) | (in[(w + 1) * 4 + l] << (32 - s))) & mask;
+            }
+        } else {
+            for (unsigned l = 0; l < 4; l++) {
+                out[k * 4 + l] = (in[w * 4 + l] >> s) & mask;
+            }
+        }
+    }
+}
+
+static inline uint64_t comchip_zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static inline int64_t comchip_unzigzag(uint64_t u) {
+    return (int64_t)(u >> 1) ^ -(int64_t)(u & 1);
+}
+
+// --- Delta-of-Delta Columns ---
+// Layout: first value (8) | first delta, zigzag (8) | group widths, padded
+// to 8 | groups. Returns the bytes written (a multiple of 8).
+static inline size_t comchip_dod_encode(const int64_t* x, size_t n, uint8_t* out) {
+    size_t m = n > 2 ? n - 2 : 0;
+    size_t groups = (m + COMCHIP_SERIES_GROUP - 1) / COMCHIP_SERIES_GROUP;
+    uint64_t first = (uint64_t)x[0];
+    uint64_t delta = n > 1 ? comchip_zigzag(x[1] - x[0]) : 0;
+    memcpy(out, &first, 8);
+    memcpy(out + 8, &delta, 8);
+    uint8_t* widths = out + 16;
+    size_t at = 16 + comchip_series_pad8(groups);
+
+    for (size_t g = 0; g < groups; g++) {
+        uint64_t zz[COMCHIP_SERIES_GROUP] = {0};
+        uint64_t any = 0;
+        for (size_t i = 0; i < COMCHIP_SERIES_GROUP && g * COMCHIP_SERIES_GROUP + i < m; i++) {
+            size_t j = g * COMCHIP_SERIES_GROUP + i + 2;
+            zz[i] = comchip_zigzag((x[j] - x[j - 1]) - (x[j - 1] - x[j - 2]));
+            any |= zz[i];
+        }
+        unsigned b = any ? 64 - (unsigned)__builtin_clzll(any) : 0;
+        if (b > 32) {
+            widths[g] = COMCHIP_SERIES_RAW64;
+            memcpy(out + at, zz, sizeof(zz));
+            at += sizeof(zz);
+        } else {
+            widths[g] = (uint8_t)b;
+            comchip_bp_pack(zz, b, (uint32_t*)(out + at));
+            at += 16 * b;
+        }
+    }
+    return comchip_series_pad8(at);
+}
+
+static inline void comchip_dod_decode(const uint8_t* in, size_t n, int64_t* x) {
+    size_t m = n > 2 ? n - 2 : 0;
+    size_t groups = (m + COMCHIP_SERIES_GROUP - 1) / COMCHIP_SERIES_GROUP;
+    uint64_t first, delta_zz;
+    memcpy(&first, in, 8);
+    memcpy(&delta_zz, in + 8, 8);
+    x[0] = (int64_t)first;
+    if (n < 2) {
+        return;
+    }
+    int64_t delta = comchip_unzigzag(delta_zz);
+    x[1] = x[0] + delta;
+    const uint8_t* widths = in + 16;
+    size_t at = 16 + comchip_series_pad8(groups);
+
+    for (size_t g = 0; g < groups; g++) {
+        uint32_t zz32[COMCHIP_SERIES_GROUP];
+        const uint64_t* zz64 = NULL;
+        if (widths[g] == COMCHIP_SERIES_RAW64) {
+            zz64 = (const uint64_t*)(in + at);
+            at += COMCHIP_SERIES_GROUP * 8;
+        } else {
+            comchip_bp_unpack((const uint32_t*)(in + at), widths[g], zz32);
+            at += 16u * widths[g];
+        }
+        size_t base = g * COMCHIP_SERIES_GROUP + 2;
+        size_t end = base + COMCHIP_SERIES_GROUP < n ? base + COMCHIP_SERIES_GROUP : n;
+        int64_t prev = x[base - 1];
+        for (size_t j = base; j < end; j++) {
+            delta += comchip_unzigzag(zz64 ? zz64[j - base] : zz32[j - base]);
+            prev += delta;
+            x[j] = prev;
+        }
+    }
+}
+
+// True if a column of n values encoded above fits in len bytes and only
+// uses widths the decoder knows
+static inline bool comchip_dod_valid(const uint8_t* in, size_t len, size_t n) {
+    size_t m = n > 2 ? n - 2 : 0;
+    size_t groups = (m + COMCHIP_SERIES_GROUP - 1) / COMCHIP_SERIES_GROUP;
+    size_t at = 16 + comchip_series_pad8(groups);
+    if (len % 8 || len < at) {
+        return false;
+    }
+    for (size_t g = 0; g < groups; g++) {
+        uint8_t w = in[16 + g];
+        if (w > 32 && w != COMCHIP_SERIES_RAW64) {
+            return false;
+        }
+        at += w == COMCHIP_SERIES_RAW64 ? COMCHIP_SERIES_GROUP * 8u : 16u * w;
+        if (at > len) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// --- Series ---
+typedef struct {
+    const ComchipSeriesBlock** blocks; // Sealed, oldest first
+    uint32_t block_count;
+    uint32_t block_cap;
+
+    // Active block, raw
+    uint64_t ts[COMCHIP_SERIES_BLOCK_SAMPLES];
+    uint16_t mV[COMCHIP_SERIES_BLOCK_SAMPLES];
+    uint8_t  status[COMCHIP_SERIES_BLOCK_SAMPLES];
+    uint16_t count;
+    uint64_t partition;
+
+    uint64_t partition_ns;
+    uint64_t last_ns;
+    int      fd;       // Sealed blocks are appended here, -1 = memory only
+    uint8_t* map;      // Blocks loaded with comchip_series_load() live here
+    size_t   map_len;
+
+    uint64_t samples;
+    uint64_t bytes;    // Sealed block bytes
+    uint64_t blocks_decoded;
+    uint64_t blocks_skipped;
+} ComchipSeries;
+
+static inline void comchip_series_init(ComchipSeries* s, uint64_t partition_ns) {
+    memset(s, 0, sizeof(*s));
+    s->partition_ns = partition_ns;
+    s->fd = -1;
+}
+
+static inline bool comchip_series_owns(const ComchipSeries* s, const void* block) {
+    return !s->map || (const uint8_t*)block < s->map || (const uint8_t*)block >= s->map + s->map_len;
+}
+
+static inline void comchip_series_free(ComchipSeries* s) {
+    for (uint32_t i = 0; i < s->block_count; i++) {
+        if (comchip_series_owns(s, s->blocks[i])) {
+            free((void*)s->blocks[i]);
+        }
+    }
+    free(s->blocks);
+    if (s->map) {
+        munmap(s->map, s->map_len);
+    }
+    if (s->fd >= 0) {
+        close(s->fd);
+    }
+    memset(s, 0, sizeof(*s));
+    s->fd = -1;
+}
+
+// Append sealed blocks to `path` from now on. Returns 0, or -1 with errno set.
+static inline int comchip_series_attach_file(ComchipSeries* s, const char* path) {
+    int fd = open(path, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return -1;
+    }
+    if (s->fd >= 0) {
+        close(s->fd);
+    }
+    s->fd = fd;
+    return 0;
+}
+
+static inline int comchip_series_push_block(ComchipSeries* s, const ComchipSeriesBlock* b) {
+    if (s->block_count == s->block_cap) {
+        uint32_t cap = s->block_cap ? s->block_cap * 2 : 64;
+        const ComchipSeriesBlock** blocks =
+            (const ComchipSeriesBlock**)realloc((void*)s->blocks, cap * sizeof(*blocks));
+        if (!blocks) {
+            errno = ENOMEM;
+            return -1;
+        }
+        s->blocks = blocks;
+        s->block_cap = cap;
+    }
+    s->blocks[s->block_count++] = b;
+    s->bytes += b->size;
+    return 0;
+}
+
+// Encode the active block (if any). Returns 0, or -1 with errno set.
+static inline int comchip_series_seal(ComchipSeries* s) {
+    if (s->count == 0) {
+        return 0;
+    }
+    _Alignas(8) uint8_t buf[COMCHIP_SERIES_MAX_BLOCK];
+    ComchipSeriesBlock* h = (ComchipSeriesBlock*)buf;
+    memset(h, 0, sizeof(*h));
+    h->magic = COMCHIP_SERIES_BLOCK_MAGIC;
+    h->count = s->count;
+    h->t_min = s->ts[0];
+    h->t_max = s->ts[s->count - 1];
+    h->mV_min = UINT16_MAX;
+    h->status_and = 0xFF;
+
+    int64_t x[COMCHIP_SERIES_BLOCK_SAMPLES];
+    for (uint16_t i = 0; i < s->count; i++) {
+        x[i] = (int64_t)s->ts[i];
+    }
+    size_t at = sizeof(*h);
+    h->ts_len = (uint32_t)comchip_dod_encode(x, s->count, buf + at);
+    at += h->ts_len;
+    for (uint16_t i = 0; i < s->count; i++) {
+        x[i] = s->mV[i];
+        h->mV_min = s->mV[i] < h->mV_min ? s->mV[i] : h->mV_min;
+        h->mV_max = s->mV[i] > h->mV_max ? s->mV[i] : h->mV_max;
+        h->status_or |= s->status[i];
+        h->status_and &= s->status[i];
+    }
+    h->mV_len = (uint32_t)comchip_dod_encode(x, s->count, buf + at);
+    at += h->mV_len;
+
+    // Status runs: lengths first (2-byte aligned), then values
+    uint16_t lengths[COMCHIP_SERIES_BLOCK_SAMPLES];
+    uint8_t values[COMCHIP_SERIES_BLOCK_SAMPLES];
+    uint16_t runs = 0;
+    for (uint16_t i = 0; i < s->count; i++) {
+        if (runs && values[runs - 1] == s->status[i]) {
+            lengths[runs - 1]++;
+        } else {
+            values[runs] = s->status[i];
+            lengths[runs++] = 1;
+        }
+    }
+    h->runs = runs;
+    memcpy(buf + at, lengths, runs * sizeof(*lengths));
+    memcpy(buf + at + runs * sizeof(*lengths), values, runs);
+    at = comchip_series_pad8(at + runs * 3u);
+    h->size = (uint32_t)at;
+
+    ComchipSeriesBlock* block = (ComchipSeriesBlock*)malloc(at);
+    if (!block) {
+        errno = ENOMEM;
+        return -1;
+    }
+    memcpy(block, buf, at);
+    if (comchip_series_push_block(s, block) < 0) {
+        free(block);
+        return -1;
+    }
+    s->count = 0;
+    if (s->fd >= 0) {
+        ssize_t n = write(s->fd, block, at);
+        if (n != (ssize_t)at) {
+            if (n >= 0) {
+                // Cut the partial block off so the next one is not appended behind it
+                off_t end = lseek(s->fd, 0, SEEK_END);
+                if (end < 0 || ftruncate(s->fd, end - n) < 0) {
+                    close(s->fd);
+                    s->fd = -1; // Stop writing rather than bury later blocks in it
+                }
+                errno = EIO;
+            }
+            return -1; // Kept in memory; the file is short a block
+        }
+    }
+    return 0;
+}
+
+// Record one sample. A timestamp earlier than the last one is raised to it.
+// Returns 0, or -1 with errno set (the sample is recorded even if writing
+// a sealed block to the file failed).
+static inline int comchip_series_append(ComchipSeries* s, uint64_t ts_ns, uint16_t mV, uint8_t status) {
+    if (ts_ns < s->last_ns) {
+        ts_ns = s->last_ns;
+    }
+    s->last_ns = ts_ns;
+    uint64_t partition = ts_ns / s->partition_ns;
+    int rc = 0;
+    if (s->count == COMCHIP_SERIES_BLOCK_SAMPLES || (s->count && partition != s->partition)) {
+        rc = comchip_series_seal(s);
+        if (rc < 0 && s->count) {
+            return -1; // Could not seal: the active block is still full
+        }
+    }
+    s->partition = partition;
+    s->ts[s->count] = ts_ns;
+    s->mV[s->count] = mV;
+    s->status[s->count] = status;
+    s->count++;
+    s->samples++;
+    return rc;
+}
+
+// True if the body of a block read from a file stays inside b->size and
+// decodes to exactly b->count samples
+static inline bool comchip_series_block_valid(const ComchipSeriesBlock* b) {
+    const uint8_t* p = (const uint8_t*)b + sizeof(*b);
+    uint64_t body = (uint64_t)b->ts_len + b->mV_len + b->runs * 3ull;
+    if (b->runs == 0 || b->runs > b->count || body > b->size - sizeof(*b) ||
+        !comchip_dod_valid(p, b->ts_len, b->count) || !comchip_dod_valid(p + b->ts_len, b->mV_len, b->count)) {
+        return false;
+    }
+    const uint8_t* runs = p + b->ts_len + b->mV_len;
+    uint32_t total = 0;
+    for (uint16_t r = 0; r < b->runs; r++) {
+        uint16_t len;
+        memcpy(&len, runs + r * 2u, 2);
+        total += len;
+    }
+    return total == b->count;
+}
+
+// Map a file written through comchip_series_attach_file() and add its
+// blocks, scanned in place. Stops at the first damaged block. Returns the
+// blocks added, or -1 with errno set.
+static inline int64_t comchip_series_load(ComchipSeries* s, const char* path) {
+    if (s->map) {
+        errno = EBUSY;
+        return -1;
+    }
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0) {
+        close(fd);
+        return -1;
+    }
+    if (st.st_size == 0) {
+        close(fd);
+        return 0;
+    }
+    void* p = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        return -1;
+    }
+    s->map = (uint8_t*)p;
+    s->map_len = (size_t)st.st_size;
+
+    int64_t added = 0;
+    for (size_t at = 0; at + sizeof(ComchipSeriesBlock) <= s->map_len;) {
+        const ComchipSeriesBlock* b = (const ComchipSeriesBlock*)(s->map + at);
+        if (b->magic != COMCHIP_SERIES_BLOCK_MAGIC || b->size < sizeof(*b) || b->size % 8 ||
+            b->size > s->map_len - at || b->count == 0 || b->count > COMCHIP_SERIES_BLOCK_SAMPLES ||
+            !comchip_series_block_valid(b)) {
+            break;
+        }
+        if (comchip_series_push_block(s, b) < 0) {
+            return -1;
+        }
+        s->samples += b->count;
+        at += b->size;
+        added++;
+    }
+    return added;
+}
+
+// --- Scans ---
+typedef struct {
+    uint64_t from_ns;    // [from_ns, to_ns)
+    uint64_t to_ns;
+    uint16_t mV_lo;      // Inclusive voltage range
+    uint16_t mV_hi;
+    uint8_t  status_any; // Samples with any of these status bits, 0 = all
+} ComchipSeriesQuery;
+
+// Every sample in [from_ns, to_ns)
+static inline ComchipSeriesQuery comchip_series_range(uint64_t from_ns, uint64_t to_ns) {
+    ComchipSeriesQuery q = { from_ns, to_ns, 0, UINT16_MAX, 0 };
+    return q;
+}
+
+// Matching samples, column by column, up to one block at a time
+typedef void (*comchip_series_cb)(void* ctx, const uint64_t* ts, const uint16_t* mV, const uint8_t* status, size_t n);
+
+static inline bool comchip_series_block_may_match(const ComchipSeriesBlock* b, const ComchipSeriesQuery* q) {
+    return b->t_max >= q->from_ns && b->t_min < q->to_ns && b->mV_max >= q->mV_lo && b->mV_min <= q->mV_hi &&
+           (q->status_any == 0 || (b->status_or & q->status_any));
+}
+
+static inline void comchip_series_decode_block(const ComchipSeriesBlock* b, uint64_t* ts, uint16_t* mV,
+                                               uint8_t* status) {
+    const uint8_t* p = (const uint8_t*)b + sizeof(*b);
+    int64_t x[COMCHIP_SERIES_BLOCK_SAMPLES];
+    comchip_dod_decode(p, b->count, (int64_t*)ts);
+    comchip_dod_decode(p + b->ts_len, b->count, x);
+    for (uint16_t i = 0; i < b->count; i++) {
+        mV[i] = (uint16_t)x[i];
+    }
+    const uint8_t* runs = p + b->ts_len + b->mV_len;
+    const uint8_t* values = runs + b->runs * 2u;
+    size_t at = 0;
+    for (uint16_t r = 0; r < b->runs; r++) {
+        uint16_t len;
+        memcpy(&len, runs + r * 2u, 2);
+        memset(status + at, values[r], len);
+        at += len;
+    }
+}
+
+// Hand the matching rows of one decoded block to cb. Returns the rows.
+static inline size_t comchip_series_emit(const ComchipSeriesQuery* q, uint64_t* ts, uint16_t* mV, uint8_t* status,
+                                         size_t n, comchip_series_cb cb, void* ctx) {
+    // Timestamps are sorted: the time range is a slice
+    size_t lo = 0, hi = n;
+    while (lo < hi && ts[lo] < q->from_ns) {
+        lo++;
+    }
+    while (hi > lo && ts[hi - 1] >= q->to_ns) {
+        hi--;
+    }
+    ts += lo;
+    mV += lo;
+    status += lo;
+    n = hi - lo;
+
+    if (q->mV_lo != 0 || q->mV_hi != UINT16_MAX || q->status_any) {
+        size_t k = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (mV[i] >= q->mV_lo && mV[i] <= q->mV_hi && (q->status_any == 0 || (status[i] & q->status_any))) {
+                ts[k] = ts[i];
+                mV[k] = mV[i];
+                status[k] = status[i];
+                k++;
+            }
+        }
+        n = k;
+    }
+    if (n) {
+        cb(ctx, ts, mV, status, n);
+    }
+    return n;
+}
+
+// Run a query over sealed blocks and the active block, oldest first.
+// Returns the samples that matched.
+static inline uint64_t comchip_series_scan(ComchipSeries* s, const ComchipSeriesQuery* q, comchip_series_cb cb,
+                                           void* ctx) {
+    uint64_t ts[COMCHIP_SERIES_BLOCK_SAMPLES];
+    uint16_t mV[COMCHIP_SERIES_BLOCK_SAMPLES];
+    uint8_t status[COMCHIP_SERIES_BLOCK_SAMPLES];
+    uint64_t matched = 0;
+
+    for (uint32_t i = 0; i < s->block_count; i++) {
+        const ComchipSeriesBlock* b = s->blocks[i];
+        if (!comchip_series_block_may_match(b, q)) {
+            s->blocks_skipped++;
+            continue;
+        }
+        s->blocks_decoded++;
+        comchip_series_decode_block(b, ts, mV, status);
+        matched += comchip_series_emit(q, ts, mV, status, b->count, cb, ctx);
+    }
+    if (s->count) {
+        memcpy(ts, s->ts, s->count * sizeof(*ts));
+        memcpy(mV, s->mV, s->count * sizeof(*mV));
+        memcpy(status, s->status, s->count);
+        matched += comchip_series_emit(q, ts, mV, status, s->count, cb, ctx);
+    }
+    return matched;
+}
+
+// --- Per-Device Store ---
+typedef struct {
+    ComchipSeries* series; // Indexed by port id
+    uint32_t       cap;
+} ComchipSeriesStore;
+
+// Returns 0, or -1 with errno set
+static inline int comchip_series_store_init(ComchipSeriesStore* st, uint32_t cap, uint64_t partition_ns) {
+    st->series = (ComchipSeries*)malloc(cap * sizeof(*st->series));
+    if (!st->series) {
+        errno = ENOMEM;
+        return -1;
+    }
+    st->cap = cap;
+    for (uint32_t i = 0; i < cap; i++) {
+        comchip_series_init(&st->series[i], partition_ns);
+    }
+    return 0;
+}
+
+static inline void comchip_series_store_free(ComchipSeriesStore* st) {
+    for (uint32_t i = 0; i < st->cap; i++) {
+        comchip_series_free(&st->series[i]);
+    }
+    free(st->series);
+    st->series = NULL;
+    st->cap = 0;
+}
+
+static inline int comchip_series_store_record(ComchipSeriesStore* st, uint32_t dev, uint64_t ts_ns,
+                                              const BatteryStatusData* data) {
+    if (dev >= st->cap) {
+        errno = EINVAL;
+        return -1;
+    }
+    return comchip_series_append(&st->series[dev], ts_ns, data->battery_voltage_mV, comchip_status_byte(data));
+}
+
+#endif // COMCHIP_SERIES_H
@@ -0,0 +1,410 @@
+// --- COMChip Parallel Capture Decoder ---
+// Decodes a mapped capture file (comchip_capture.h) on all cores. The chunk
+// sequence is cut into shards of consecutive chunks; chunk headers are the
+// safe cut points, as they never sit inside a port's bytes. Every port's
+// byte stream runs across the cuts, though, and a frame may begin in one
+// shard and end in the next. Two passes over the shards take care of that:
+//     1. Each shard records, per port, the last few bytes it holds (one
+//        frame minus a byte, COMCHIP_SHARD_CARRY).
+//     2. Each shard's per-port decoders are first fed the bytes the earlier
+//        shards left over (the overlap), with output suppressed, and then
+//        decode the shard's own chunks. A frame straddling a cut is thus
+//        completed and reported by the shard it ends in, and only there.
+// Pass 1 touches each chunk's tail bytes only; the carry-over between shards
+// is a tiny sequential step; both passes run on a pool of threads that take
+// shards from a shared counter, so a slow shard does not hold up the others.
+//
+// Frames are tagged with their chunk's timestamp and port. Shards cover
+// consecutive parts of the file and capture timestamps never go backwards,
+// so handing the shards' results over in shard order is a merge in
+// timestamp order; the calling thread delivers each shard as soon as it and
+// all shards before it are done, and frees it. A frame still held at the end
+// of the capture (a detecting decoder waits for a possible Byte2) is flushed
+// by the shard holding its port's last chunk, tagged with that chunk, and
+// sorted into that shard's frames.
+//
+// Each port's layout is detected up front from the start of the capture and
+// preset in every shard's decoder, so shards do not each re-detect it. A
+// port whose layout cannot be told from its first bytes is left detecting in
+// every shard; a port that changes layout mid-capture may then lose or
+// repeat a frame right at a cut.
+
+#ifndef COMCHIP_SHARD_H
+#define COMCHIP_SHARD_H
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "comchip_capture.h"
+#include "comchip_stream.h"
+
+#define COMCHIP_SHARD_CARRY       (COMCHIP_MAX_STATUS_FRAME_LEN - 1)
+#define COMCHIP_SHARD_PER_THREAD  8            // Shards per thread, to even out the load
+#define COMCHIP_SHARD_PROBE_BYTES (64 * 1024)  // Per port, for layout detection
+#define COMCHIP_SHARD_MAX_THREADS 256
+
+typedef struct {
+    uint64_t          timestamp_ns; // Of the chunk the frame ended in
+    uint16_t          port;
+    BatteryStatusData data;
+} ComchipCaptureFrame;
+
+// Called on the calling thread with frames in timestamp order
+typedef void (*comchip_capture_frames_cb)(void* ctx, const ComchipCaptureFrame* frames, size_t n);
+
+typedef struct {
+    uint8_t len;
+    bool    seen; // Pass 1: the shard holds a chunk of the port
+    uint8_t bytes[COMCHIP_SHARD_CARRY];
+} ComchipShardCarry;
+
+typedef struct ComchipShardJob ComchipShardJob;
+
+typedef struct {
+    ComchipShardJob*   job;
+    uint64_t           first; // Chunk range [first, last)
+    uint64_t           last;
+    ComchipShardCarry* tail;  // Pass 1 result, per port
+    ComchipShardCarry* carry; // Pass 2 input, per port
+
+    ComchipCaptureFrame* frames;
+    size_t               len;
+    size_t               cap;
+
+    // Decoding state
+    uint64_t timestamp_ns;
+    uint16_t port;
+    bool     emitting;
+    bool     failed;          // Out of memory
+    bool     done;            // Guarded by job->lock
+} ComchipShard;
+
+struct ComchipShardJob {
+    const ComchipCaptureReader* reader;
+    uint64_t*      offsets;   // Chunk offsets when the capture has no index
+    uint16_t       ports;
+    const uint8_t* layouts;   // Per port, 0 = detect
+    const uint32_t* last_shard; // Per port, shard holding its last chunk
+    ComchipShard*  shards;
+    uint32_t       count;
+    uint32_t       next;      // Next shard to take (atomic)
+    int            pass;
+
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;     // A shard finished pass 2
+};
+
+static inline void comchip_shard_carry_append(ComchipShardCarry* c, const uint8_t* data, size_t len) {
+    if (len >= COMCHIP_SHARD_CARRY) {
+        memcpy(c->bytes, data + len - COMCHIP_SHARD_CARRY, COMCHIP_SHARD_CARRY);
+        c->len = COMCHIP_SHARD_CARRY;
+        return;
+    }
+    size_t keep = c->len + len > COMCHIP_SHARD_CARRY ? COMCHIP_SHARD_CARRY - len : c->len;
+    memmove(c->bytes, c->bytes + c->len - keep, keep);
+    memcpy(c->bytes + keep, data, len);
+    c->len = (uint8_t)(keep + len);
+}
+
+static inline bool comchip_shard_chunk(const ComchipShardJob* job, uint64_t i, ComchipCaptureChunk* out) {
+    size_t offset = (size_t)(job->offsets ? job->offsets[i] : job->reader->index[i].offset);
+    return comchip_capture_next(job->reader, &offset, out);
+}
+
+// --- Decoding ---
+static inline void comchip_shard_on_frame(void* ctx, const BatteryStatusData* data) {
+    ComchipShard* s = (ComchipShard*)ctx;
+    if (!s->emitting) {
+        return;
+    }
+    if (s->len == s->cap) {
+        size_t cap = s->cap ? s->cap * 2 : 4096;
+        ComchipCaptureFrame* frames = (ComchipCaptureFrame*)realloc(s->frames, cap * sizeof(*frames));
+        if (!frames) {
+            s->failed = true;
+            return;
+        }
+        s->frames = frames;
+        s->cap = cap;
+    }
+    ComchipCaptureFrame* f = &s->frames[s->len++];
+    f->timestamp_ns = s->timestamp_ns;
+    f->port = s->port;
+    f->data = *data;
+}
+
+static inline void comchip_shard_scan(ComchipShard* s) {
+    const ComchipShardJob* job = s->job;
+    ComchipCaptureChunk c;
+    for (uint64_t i = s->first; i < s->last && comchip_shard_chunk(job, i, &c); i++) {
+        if (c.port < job->ports) {
+            comchip_shard_carry_append(&s->tail[c.port], c.data, c.len);
+            s->tail[c.port].seen = true;
+        }
+    }
+}
+
+static inline void comchip_shard_decode(ComchipShard* s) {
+    const ComchipShardJob* job = s->job;
+    ComchipStream* streams = (ComchipStream*)malloc(job->ports * sizeof(*streams));
+    uint64_t* last_ts = (uint64_t*)calloc(job->ports, sizeof(*last_ts));
+    if (!streams || !last_ts) {
+        free(streams);
+        free(last_ts);
+        s->failed = true;
+        return;
+    }
+
+    // Overlap: what earlier shards left of each port's last frame
+    s->emitting = false;
+    for (uint16_t p = 0; p < job->ports; p++) {
+        comchip_stream_init(&streams[p], comchip_shard_on_frame, s);
+        if (job->layouts[p]) {
+            comchip_stream_set_layout(&streams[p], job->layouts[p]);
+        }
+        s->port = p;
+        comchip_stream_feed(&streams[p], s->carry[p].bytes, s->carry[p].len);
+    }
+
+    s->emitting = true;
+    ComchipCaptureChunk c;
+    for (uint64_t i = s->first; i < s->last && comchip_shard_chunk(job, i, &c); i++) {
+        if (c.port < job->ports) {
+            s->timestamp_ns = c.timestamp_ns;
+            s->port = c.port;
+            last_ts[c.port] = c.timestamp_ns;
+            comchip_stream_feed(&streams[c.port], c.data, c.len);
+        }
+    }
+    // End of the capture for ports whose last chunk is in this shard. Their
+    // frames are tagged with that chunk, so sort them in among the rest.
+    size_t flushed_from = s->len;
+    uint32_t k = (uint32_t)(s - job->shards);
+    for (uint16_t p = 0; p < job->ports; p++) {
+        if (job->last_shard[p] == k) {
+            s->timestamp_ns = last_ts[p];
+            s->port = p;
+            comchip_stream_flush(&streams[p]);
+        }
+    }
+    for (size_t i = flushed_from; i < s->len; i++) {
+        ComchipCaptureFrame f = s->frames[i];
+        size_t j = i;
+        for (; j > 0 && s->frames[j - 1].timestamp_ns > f.timestamp_ns; j--) {
+            s->frames[j] = s->frames[j - 1];
+        }
+        s->frames[j] = f;
+    }
+    free(streams);
+    free(last_ts);
+}
+
+static void* comchip_shard_worker(void* arg) {
+    ComchipShardJob* job = (ComchipShardJob*)arg;
+    uint32_t k;
+    while ((k = __atomic_fetch_add(&job->next, 1, __ATOMIC_RELAXED)) < job->count) {
+        ComchipShard* s = &job->shards[k];
+        if (job->pass == 1) {
+            comchip_shard_scan(s);
+            continue;
+        }
+        comchip_shard_decode(s);
+        pthread_mutex_lock(&job->lock);
+        s->done = true;
+        pthread_cond_broadcast(&job->cond);
+        pthread_mutex_unlock(&job->lock);
+    }
+    return NULL;
+}
+
+// Run one pass on `threads` threads (the calling thread is not one of them)
+static inline int comchip_shard_start(ComchipShardJob* job, int pass, pthread_t* tids, unsigned threads) {
+    job->pass = pass;
+    job->next = 0;
+    for (unsigned t = 0; t < threads; t++) {
+        int rc = pthread_create(&tids[t], NULL, comchip_shard_worker, job);
+        if (rc != 0) {
+            __atomic_store_n(&job->next, job->count, __ATOMIC_RELAXED); // Stop the ones already running
+            for (unsigned u = 0; u < t; u++) {
+                pthread_join(tids[u], NULL);
+            }
+            errno = rc;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static inline void comchip_shard_join(pthread_t* tids, unsigned threads) {
+    for (unsigned t = 0; t < threads; t++) {
+        pthread_join(tids[t], NULL);
+    }
+}
+
+// Layout of each port from its first COMCHIP_SHARD_PROBE_BYTES, 0 if undecided
+static inline void comchip_shard_probe(const ComchipShardJob* job, uint64_t chunks, uint8_t* layouts) {
+    ComchipStream* streams = (ComchipStream*)malloc(job->ports * sizeof(*streams));
+    uint64_t* seen = (uint64_t*)calloc(job->ports, sizeof(*seen));
+    if (streams && seen) {
+        for (uint16_t p = 0; p < job->ports; p++) {
+            comchip_stream_init(&streams[p], NULL, NULL);
+        }
+        uint32_t open = job->ports;
+        ComchipCaptureChunk c;
+        for (uint64_t i = 0; i < chunks && open && comchip_shard_chunk(job, i, &c); i++) {
+            if (c.port >= job->ports || seen[c.port] >= COMCHIP_SHARD_PROBE_BYTES) {
+                continue;
+            }
+            comchip_stream_feed(&streams[c.port], c.data, c.len);
+            seen[c.port] += c.len;
+            if (streams[c.port].layout_len || seen[c.port] >= COMCHIP_SHARD_PROBE_BYTES) {
+                layouts[c.port] = streams[c.port].layout_len;
+                seen[c.port] = COMCHIP_SHARD_PROBE_BYTES;
+                open--;
+            }
+        }
+    }
+    free(streams);
+    free(seen);
+}
+
+// --- Entry Point ---
+// Decode every chunk of ports below `ports` on `threads` threads (0: one
+// per online CPU) and hand the frames to on_frames in timestamp order.
+// Returns the frames decoded, or -1 with errno set.
+static inline int64_t comchip_capture_decode_parallel(const ComchipCaptureReader* r, uint16_t ports,
+                                                      unsigned threads, comchip_capture_frames_cb on_frames,
+                                                      void* ctx) {
+    if (threads == 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = n > 0 ? (unsigned)n : 1;
+    }
+    if (threads > COMCHIP_SHARD_MAX_THREADS) {
+        threads = COMCHIP_SHARD_MAX_THREADS;
+    }
+
+    ComchipShardJob job;
+    memset(&job, 0, sizeof(job));
+    job.reader = r;
+    job.ports = ports;
+
+    // Chunk offsets: the index, or one walk over the chunk headers
+    uint64_t chunks = r->chunk_count;
+    if (!r->index) {
+        size_t cap = 0;
+        ComchipCaptureChunk c;
+        for (size_t off = comchip_capture_begin(r), at = off; comchip_capture_next(r, &off, &c); at = off) {
+            if (chunks == cap) {
+                cap = cap ? cap * 2 : 4096;
+                uint64_t* offsets = (uint64_t*)realloc(job.offsets, cap * sizeof(*offsets));
+                if (!offsets) {
+                    free(job.offsets);
+                    errno = ENOMEM;
+                    return -1;
+                }
+                job.offsets = offsets;
+            }
+            job.offsets[chunks++] = at;
+        }
+    }
+
+    uint64_t count = (uint64_t)threads * COMCHIP_SHARD_PER_THREAD;
+    if (count > chunks) {
+        count = chunks ? chunks : 1;
+    }
+    job.count = (uint32_t)count;
+    job.shards = (ComchipShard*)calloc(job.count, sizeof(*job.shards));
+    uint8_t* layouts = (uint8_t*)calloc(ports, 1);
+    uint32_t* last_shard = (uint32_t*)malloc(ports * sizeof(*last_shard));
+    ComchipShardCarry* carries = (ComchipShardCarry*)calloc((size_t)job.count * ports * 2, sizeof(*carries));
+    pthread_t* tids = (pthread_t*)malloc(threads * sizeof(*tids));
+    int64_t result = -1;
+    if (!job.shards || !layouts || !last_shard || !carries || !tids) {
+        errno = ENOMEM;
+        goto out;
+    }
+    for (uint32_t k = 0; k < job.count; k++) {
+        ComchipShard* s = &job.shards[k];
+        s->job = &job;
+        s->first = chunks * k / job.count;
+        s->last = chunks * (k + 1) / job.count;
+        s->tail = &carries[(size_t)k * ports * 2];
+        s->carry = s->tail + ports;
+    }
+    comchip_shard_probe(&job, chunks, layouts);
+    job.layouts = layouts;
+    pthread_mutex_init(&job.lock, NULL);
+    pthread_cond_init(&job.cond, NULL);
+
+    // Pass 1, then what each shard inherits from the ones before it
+    if (comchip_shard_start(&job, 1, tids, threads) < 0) {
+        goto out_sync;
+    }
+    comchip_shard_join(tids, threads);
+    for (uint16_t p = 0; p < ports; p++) {
+        last_shard[p] = UINT32_MAX; // No chunk: nothing to flush
+    }
+    for (uint32_t k = 0; k < job.count; k++) {
+        for (uint16_t p = 0; p < ports; p++) {
+            if (job.shards[k].tail[p].seen) {
+                last_shard[p] = k;
+            }
+        }
+    }
+    job.last_shard = last_shard;
+    for (uint32_t k = 1; k < job.count; k++) {
+        for (uint16_t p = 0; p < ports; p++) {
+            ComchipShardCarry* c = &job.shards[k].carry[p];
+            *c = job.shards[k - 1].carry[p];
+            comchip_shard_carry_append(c, job.shards[k - 1].tail[p].bytes, job.shards[k - 1].tail[p].len);
+        }
+    }
+
+    // Pass 2, delivering shards in order as they complete
+    if (comchip_shard_start(&job, 2, tids, threads) < 0) {
+        goto out_sync;
+    }
+    result = 0;
+    for (uint32_t k = 0; k < job.count; k++) {
+        ComchipShard* s = &job.shards[k];
+        pthread_mutex_lock(&job.lock);
+        while (!s->done) {
+            pthread_cond_wait(&job.cond, &job.lock);
+        }
+        pthread_mutex_unlock(&job.lock);
+        if (s->failed) {
+            result = -1;
+        }
+        if (result >= 0 && s->len) {
+            on_frames(ctx, s->frames, s->len);
+            result += (int64_t)s->len;
+        }
+        free(s->frames);
+        s->frames = NULL;
+    }
+    comchip_shard_join(tids, threads);
+    if (result < 0) {
+        errno = ENOMEM;
+    }
+
+out_sync:
+    pthread_cond_destroy(&job.cond);
+    pthread_mutex_destroy(&job.lock);
+out:
+    if (job.shards) {
+        for (uint32_t k = 0; k < job.count; k++) {
+            free(job.shards[k].frames);
+        }
+    }
+    free(job.shards);
+    free(layouts);
+    free(last_shard);
+    free(carries);
+    free(tids);
+    free(job.offsets);
+    return result;
+}
+
+#endif // COMCHIP_SHARD_H
@@ -0,0 +1,326 @@
+// --- COMChip Streaming Frame Decoder ---
+// Takes raw bytes in whatever chunks read() hands back, hunts for
+// COMCHIP_SYNC_BYTE, and emits a BatteryStatusData for every frame whose CID
+// and checksum are valid. Frames that lie completely inside a chunk are
+// validated in place; only the few bytes of a frame split across two chunks
+// are carried over in the decoder itself.
+//
+// One decoder serves one port. The port's frame layout (6-byte, or 7-byte
+// with Byte2) is detected from the first checksum-valid frames: a candidate
+// is tried against both layouts and once COMCHIP_STREAM_DETECT_FRAMES frames
+// in a row match only one of them, the decoder locks onto that layout and
+// switches to a feed function compiled for it, so locked frames pay no layout
+// check. If half or more of the SYNC+CID candidates in a window then fail
+// their checksum, the decoder drops back to detection.
+
+#ifndef COMCHIP_STREAM_H
+#define COMCHIP_STREAM_H
+
+#include <string.h>
+
+#include "comchip.h"
+#include "comchip_layout.h"
+
+// Consecutive frames matching only one layout needed to lock onto it
+#define COMCHIP_STREAM_DETECT_FRAMES   3
+// Candidates per health window while locked, and failures (at least) that trigger re-detection
+#define COMCHIP_STREAM_HEALTH_WINDOW   64
+#define COMCHIP_STREAM_HEALTH_FAILURES 32
+
+// Called once for every decoded frame
+typedef void (*comchip_frame_cb)(void* ctx, const BatteryStatusData* data);
+
+typedef struct ComchipStream ComchipStream;
+
+// Feed function for the decoder's current mode; returns the bytes consumed.
+// It may stop early after switching modes, the caller then continues with the new one.
+typedef size_t (*comchip_stream_feed_fn)(ComchipStream* s, const uint8_t* chunk, size_t len);
+
+struct ComchipStream {
+    uint8_t  frame[COMCHIP_MAX_STATUS_FRAME_LEN]; // Partial frame carried across chunks
+    uint8_t  have;                                // Bytes currently held in frame[]
+
+    comchip_stream_feed_fn feed;
+    uint8_t  layout_len;    // Locked frame length, 0 while detecting
+    uint8_t  votes_len;     // Layout the current run of detection votes is for
+    uint8_t  votes;         // Length of that run
+    uint32_t window_candidates;
+    uint32_t window_failures;
+
+    comchip_frame_cb on_frame;
+    void*    ctx;
+
+    // Counters for link diagnostics
+    uint64_t frames_ok;
+    uint64_t bytes_skipped;       // Junk discarded while hunting for SYNC
+    uint64_t cid_mismatches;      // SYNC byte not followed by the expected CID
+    uint64_t checksum_mismatches;
+    uint64_t redetections;        // Times a locked layout was dropped
+};
+
+static size_t comchip_stream_feed_detect(ComchipStream* s, const uint8_t* chunk, size_t len);
+static size_t comchip_stream_feed_locked6(ComchipStream* s, const uint8_t* chunk, size_t len);
+static size_t comchip_stream_feed_locked7(ComchipStream* s, const uint8_t* chunk, size_t len);
+
+static inline void comchip_stream_init(ComchipStream* s, comchip_frame_cb on_frame, void* ctx) {
+    memset(s, 0, sizeof(*s));
+    s->feed = comchip_stream_feed_detect;
+    s->on_frame = on_frame;
+    s->ctx = ctx;
+}
+
+// Skip held bytes up to the next SYNC at or after `from` whose CID, once held, is valid.
+static inline void comchip_stream_skip_held(ComchipStream* s, uint8_t from) {
+    for (;;) {
+        const uint8_t* next = NULL;
+        if (s->have > from) {
+            next = (const uint8_t*)memchr(&s->frame[from], COMCHIP_SYNC_BYTE, (size_t)(s->have - from));
+        }
+        if (!next) {
+            s->bytes_skipped += s->have;
+            s->have = 0;
+            return;
+        }
+        uint8_t drop = (uint8_t)(next - s->frame);
+        s->bytes_skipped += drop;
+        s->have = (uint8_t)(s->have - drop);
+        memmove(s->frame, next, s->have);
+
+        // CID is checked as soon as it is available
+        if (s->have < 2 || s->frame[1] == COMCHIP_CID_GET_STATUS_RESP) {
+            return;
+        }
+        s->cid_mismatches++;
+        from = 1;
+    }
+}
+
+// Drop the first `used` held bytes (an accepted frame) and realign on what is left
+static inline void comchip_stream_consume_held(ComchipStream* s, uint8_t used) {
+    s->have = (uint8_t)(s->have - used);
+    memmove(s->frame, &s->frame[used], s->have);
+    comchip_stream_skip_held(s, 0);
+}
+
+static inline void comchip_stream_emit(ComchipStream* s, const uint8_t* f, const ComchipStatusLayout layout) {
+    BatteryStatusData data;
+    comchip_layout_decode(f, layout, &data);
+    s->frames_ok++;
+    if (s->on_frame) {
+        s->on_frame(s->ctx, &data);
+    }
+}
+
+static inline void comchip_stream_lock(ComchipStream* s, uint8_t layout_len) {
+    s->layout_len = layout_len;
+    s->feed = layout_len == COMCHIP_STATUS_FRAME_LEN ? comchip_stream_feed_locked6 : comchip_stream_feed_locked7;
+    s->window_candidates = 0;
+    s->window_failures = 0;
+}
+
+static inline void comchip_stream_unlock(ComchipStream* s) {
+    s->layout_len = 0;
+    s->feed = comchip_stream_feed_detect;
+    s->votes = 0;
+    s->redetections++;
+}
+
+// Start locked when the port's firmware (and so its layout) is known. While
+// detecting, a 6-byte frame is held until the next byte shows whether Byte2
+// follows; on a polled link that byte only comes with the next response.
+// Returns false for a length that is not a status layout.
+static inline bool comchip_stream_set_layout(ComchipStream* s, uint8_t layout_len) {
+    if (layout_len != COMCHIP_STATUS_FRAME_LEN && layout_len != COMCHIP_STATUS_FRAME_LEN_BYTE2) {
+        return false;
+    }
+    comchip_stream_lock(s, layout_len);
+    return true;
+}
+
+// --- Locked Mode ---
+// Validate one complete candidate (CID already known good) for a fixed layout.
+// Returns false on checksum mismatch; may switch the decoder back to detection.
+static COMCHIP_ALWAYS_INLINE bool comchip_stream_try_locked(ComchipStream* s, const uint8_t* f,
+                                                            const ComchipStatusLayout layout) {
+    bool ok = comchip_layout_checksum(f, layout) == f[layout.frame_len - 1];
+    if (ok) {
+        comchip_stream_emit(s, f, layout);
+    } else {
+        s->checksum_mismatches++;
+        s->window_failures++;
+    }
+    if (++s->window_candidates == COMCHIP_STREAM_HEALTH_WINDOW) {
+        if (s->window_failures >= COMCHIP_STREAM_HEALTH_FAILURES) {
+            comchip_stream_unlock(s);
+        }
+        s->window_candidates = 0;
+        s->window_failures = 0;
+    }
+    return ok;
+}
+
+static COMCHIP_ALWAYS_INLINE size_t comchip_stream_feed_layout(ComchipStream* s, const uint8_t* chunk, size_t len,
+                                                               const ComchipStatusLayout layout) {
+    size_t i = 0;
+
+    while (i < len && s->feed != comchip_stream_feed_detect) {
+        if (s->have == 0) {
+            // 1. Hunt for SYNC, skipping junk a word at a time via memchr
+            const uint8_t* p = (const uint8_t*)memchr(chunk + i, COMCHIP_SYNC_BYTE, len - i);
+            if (!p) {
+                s->bytes_skipped += len - i;
+                return len;
+            }
+            s->bytes_skipped += (size_t)(p - (chunk + i));
+            i = (size_t)(p - chunk);
+
+            // 2. Fast path: whole frame is inside this chunk, validate without copying
+            if (len - i >= layout.frame_len) {
+                if (chunk[i + 1] != COMCHIP_CID_GET_STATUS_RESP) {
+                    s->cid_mismatches++;
+                } else if (comchip_stream_try_locked(s, chunk + i, layout)) {
+                    i += layout.frame_len;
+                    continue;
+                }
+                s->bytes_skipped++;
+                i++; // Resync starting at the byte after this SYNC
+                continue;
+            }
+        }
+
+        // 3. Slow path: frame straddles the end of the chunk, carry it over byte by byte
+        s->frame[s->have++] = chunk[i++];
+        if (s->have == 2 && s->frame[1] != COMCHIP_CID_GET_STATUS_RESP) {
+            s->cid_mismatches++;
+            comchip_stream_skip_held(s, 1);
+        } else if (s->have == layout.frame_len) {
+            if (comchip_stream_try_locked(s, s->frame, layout)) {
+                s->have = 0;
+            } else {
+                comchip_stream_skip_held(s, 1);
+            }
+        }
+    }
+    return i;
+}
+
+static size_t comchip_stream_feed_locked6(ComchipStream* s, const uint8_t* chunk, size_t len) {
+    return comchip_stream_feed_layout(s, chunk, len, COMCHIP_LAYOUT_STATUS6);
+}
+
+static size_t comchip_stream_feed_locked7(ComchipStream* s, const uint8_t* chunk, size_t len) {
+    return comchip_stream_feed_layout(s, chunk, len, COMCHIP_LAYOUT_STATUS7);
+}
+
+// --- Detection Mode ---
+// `f` holds `avail` bytes of a candidate with a valid CID. Both layouts are
+// tried; a frame that matches only one of them is emitted and votes for it.
+// If both match, it is emitted with the layout currently leading but does not
+// vote. Returns the bytes the frame used, or 0 if neither layout matched.
+static inline uint8_t comchip_stream_try_detect(ComchipStream* s, const uint8_t* f, size_t avail) {
+    bool ok6 = avail >= COMCHIP_STATUS_FRAME_LEN &&
+               comchip_layout_checksum(f, COMCHIP_LAYOUT_STATUS6) == f[COMCHIP_STATUS_FRAME_LEN - 1];
+    bool ok7 = avail >= COMCHIP_STATUS_FRAME_LEN_BYTE2 &&
+               comchip_layout_checksum(f, COMCHIP_LAYOUT_STATUS7) == f[COMCHIP_STATUS_FRAME_LEN_BYTE2 - 1];
+
+    if (!ok6 && !ok7) {
+        s->checksum_mismatches++;
+        return 0;
+    }
+
+    uint8_t used;
+    if (ok6 && ok7) {
+        used = s->votes_len == COMCHIP_STATUS_FRAME_LEN_BYTE2 ? COMCHIP_STATUS_FRAME_LEN_BYTE2 : COMCHIP_STATUS_FRAME_LEN;
+    } else {
+        used = ok6 ? COMCHIP_STATUS_FRAME_LEN : COMCHIP_STATUS_FRAME_LEN_BYTE2;
+        s->votes = s->votes_len == used ? (uint8_t)(s->votes + 1) : 1;
+        s->votes_len = used;
+    }
+    comchip_stream_emit(s, f, used == COMCHIP_STATUS_FRAME_LEN ? COMCHIP_LAYOUT_STATUS6 : COMCHIP_LAYOUT_STATUS7);
+
+    if (s->votes >= COMCHIP_STREAM_DETECT_FRAMES) {
+        comchip_stream_lock(s, s->votes_len);
+    }
+    return used;
+}
+
+// Detection needs the longest layout's worth of bytes before it can decide,
+// so a frame at the very end of the input waits for comchip_stream_flush().
+static size_t comchip_stream_feed_detect(ComchipStream* s, const uint8_t* chunk, size_t len) {
+    size_t i = 0;
+
+    while (i < len && s->feed == comchip_stream_feed_detect) {
+        if (s->have == 0) {
+            const uint8_t* p = (const uint8_t*)memchr(chunk + i, COMCHIP_SYNC_BYTE, len - i);
+            if (!p) {
+                s->bytes_skipped += len - i;
+                return len;
+            }
+            s->bytes_skipped += (size_t)(p - (chunk + i));
+            i = (size_t)(p - chunk);
+
+            if (len - i >= COMCHIP_MAX_STATUS_FRAME_LEN) {
+                uint8_t used = 0;
+                if (chunk[i + 1] != COMCHIP_CID_GET_STATUS_RESP) {
+                    s->cid_mismatches++;
+                } else {
+                    used = comchip_stream_try_detect(s, chunk + i, len - i);
+                }
+                if (used) {
+                    i += used;
+                } else {
+                    s->bytes_skipped++;
+                    i++;
+                }
+                continue;
+            }
+        }
+
+        s->frame[s->have++] = chunk[i++];
+        if (s->have == 2 && s->frame[1] != COMCHIP_CID_GET_STATUS_RESP) {
+            s->cid_mismatches++;
+            comchip_stream_skip_held(s, 1);
+        } else if (s->have == COMCHIP_MAX_STATUS_FRAME_LEN) {
+            uint8_t used = comchip_stream_try_detect(s, s->frame, s->have);
+            if (used) {
+                comchip_stream_consume_held(s, used);
+            } else {
+                comchip_stream_skip_held(s, 1);
+            }
+        }
+    }
+    return i;
+}
+
+// --- Feed an Arbitrary Chunk of Received Bytes ---
+// Returns the number of frames decoded from this chunk.
+static inline size_t comchip_stream_feed(ComchipStream* s, const uint8_t* chunk, size_t len) {
+    uint64_t before = s->frames_ok;
+    size_t i = 0;
+
+    while (i < len) {
+        i += s->feed(s, chunk + i, len - i);
+    }
+    return (size_t)(s->frames_ok - before);
+}
+
+// --- End of Input ---
+// While detecting, a 6-byte frame at the very end of the input is still held
+// waiting for a possible Byte2. Call this when no more bytes will arrive.
+static inline size_t comchip_stream_flush(ComchipStream* s) {
+    uint64_t before = s->frames_ok;
+
+    while (s->layout_len == 0 && s->have >= COMCHIP_STATUS_FRAME_LEN) {
+        uint8_t used = comchip_stream_try_detect(s, s->frame, s->have);
+        if (used) {
+            comchip_stream_consume_held(s, used);
+        } else {
+            comchip_stream_skip_held(s, 1);
+        }
+    }
+    s->bytes_skipped += s->have;
+    s->have = 0;
+    return (size_t)(s->frames_ok - before);
+}
+
+#endif // COMCHIP_STREAM_H
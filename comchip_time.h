@@ -0,0 +1,33 @@
+// --- COMChip Monotonic Clock ---
+// Timestamps for deadlines, round-trip times and captures, in nanoseconds of
+// CLOCK_MONOTONIC: never jumps with wall-clock changes.
+
+#ifndef COMCHIP_TIME_H
+#define COMCHIP_TIME_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define COMCHIP_NS_PER_MS 1000000ull
+#define COMCHIP_NS_PER_S  1000000000ull
+
+static inline uint64_t comchip_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * COMCHIP_NS_PER_S + (uint64_t)ts.tv_nsec;
+}
+
+// Milliseconds to wait for something due at `due_ns`, rounded up, for
+// epoll_wait()-style timeouts. UINT64_MAX (nothing due) gives -1 (forever).
+static inline int comchip_timeout_ms(uint64_t due_ns, uint64_t now_ns) {
+    if (due_ns == UINT64_MAX) {
+        return -1;
+    }
+    if (due_ns <= now_ns) {
+        return 0;
+    }
+    uint64_t ms = (due_ns - now_ns + COMCHIP_NS_PER_MS - 1) / COMCHIP_NS_PER_MS;
+    return ms > INT32_MAX ? INT32_MAX : (int)ms;
+}
+
+#endif // COMCHIP_TIME_H
@@ -0,0 +1,411 @@
+// --- COMChip io_uring Backend ---
+// Keeps one read posted on every port at all times. Each port's receive
+// buffer is registered with the kernel once (IORING_REGISTER_BUFFERS), and
+// reads are IORING_OP_READ_FIXED into that buffer, so completed bytes are
+// already sitting in the port's decoder buffer when the completion is
+// reaped. Each loop iteration is a single io_uring_enter() that submits the
+// reads re-armed in the previous iteration and waits for new completions,
+// instead of epoll_wait() plus one read() per ready port.
+//
+// Reads are re-armed one at a time rather than multishot:
+// IORING_OP_READ_MULTISHOT only works with provided-buffer rings, which would
+// hand the kernel a shared pool instead of each port's own decoder buffer.
+//
+// Written against the raw syscalls and <linux/io_uring.h> (no liburing).
+// comchip_uring_init() fails with errno set when the kernel lacks io_uring or
+// a needed feature, or when it is disabled; see comchip_ingest.h for the
+// fallback to the epoll reactor.
+
+#ifndef COMCHIP_URING_H
+#define COMCHIP_URING_H
+
+#include <stdlib.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#include "comchip_event.h"
+#include "comchip_serial.h"
+
+#define COMCHIP_URING_READ_LEN   1024       // Bytes requested per posted read
+#define COMCHIP_URING_CANCEL_TAG UINT64_MAX // user_data of cancel requests
+
+typedef struct ComchipUring ComchipUring;
+
+typedef struct {
+    ComchipPort   port;      // port.fd is the blocking descriptor reads are posted on
+    int           owner_fd;  // The fd handed to comchip_uring_add(), left as it was
+    ComchipUring* uring;
+    uint32_t      id;
+    bool          active;    // Added and not removed or hung up
+    bool          in_flight; // A read is posted
+} ComchipUringPort;
+
+struct ComchipUring {
+    int ring_fd;
+
+    // Submission queue
+    void*                sq_ring;
+    size_t               sq_ring_sz;
+    struct io_uring_sqe* sqes;
+    size_t               sqes_sz;
+    uint32_t*            sq_head;
+    uint32_t*            sq_tail;
+    uint32_t*            sq_array;
+    uint32_t             sq_mask;
+    uint32_t             sq_entries;
+    uint32_t             sq_local_tail; // Written but not yet published
+    uint32_t             sq_unsubmitted;
+
+    // Completion queue
+    void*                cq_ring; // Same mapping as sq_ring with IORING_FEAT_SINGLE_MMAP
+    size_t               cq_ring_sz;
+    uint32_t*            cq_head;
+    uint32_t*            cq_tail;
+    uint32_t             cq_mask;
+    struct io_uring_cqe* cqes;
+
+    ComchipUringPort* ports;
+    uint32_t          ports_cap;
+    uint32_t*         free_ids;
+    uint32_t          free_count;
+
+    ComchipEventBatch out;
+
+    // Counters for diagnostics
+    uint64_t enters;      // io_uring_enter() calls
+    uint64_t completions;
+};
+
+// --- Raw Syscalls ---
+static inline int comchip_uring_setup(unsigned entries, struct io_uring_params* p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static inline int comchip_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+                                      const void* arg, size_t argsz) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+static inline int comchip_uring_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+// --- Submission ---
+// Publish written SQEs and hand them to the kernel, optionally waiting for
+// completions. Returns 0, or -1 with errno set (ETIME when the wait timed out).
+static inline int comchip_uring_submit(ComchipUring* u, unsigned min_complete, int timeout_ms) {
+    __atomic_store_n(u->sq_tail, u->sq_local_tail, __ATOMIC_RELEASE);
+
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    if (min_complete && timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000;
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+    }
+
+    unsigned flags = min_complete ? IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG : 0;
+    for (;;) {
+        u->enters++;
+        int n = comchip_uring_enter(u->ring_fd, u->sq_unsubmitted, min_complete, flags,
+                                    min_complete ? &arg : NULL, min_complete ? sizeof(arg) : 0);
+        if (n >= 0) {
+            u->sq_unsubmitted -= (uint32_t)n;
+            return 0;
+        }
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+}
+
+static inline struct io_uring_sqe* comchip_uring_get_sqe(ComchipUring* u) {
+    if (u->sq_local_tail - __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE) == u->sq_entries) {
+        comchip_uring_submit(u, 0, 0); // Queue full: hand over what is there first
+    }
+    uint32_t idx = u->sq_local_tail & u->sq_mask;
+    struct io_uring_sqe* sqe = &u->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    u->sq_array[idx] = idx;
+    u->sq_local_tail++;
+    u->sq_unsubmitted++;
+    return sqe;
+}
+
+static inline void comchip_uring_post_read(ComchipUring* u, ComchipUringPort* up) {
+    struct io_uring_sqe* sqe = comchip_uring_get_sqe(u);
+    sqe->opcode = IORING_OP_READ_FIXED;
+    sqe->fd = up->port.fd;
+    sqe->addr = (uint64_t)(uintptr_t)up->port.rx;
+    sqe->len = COMCHIP_URING_READ_LEN;
+    sqe->off = (uint64_t)-1; // Current position; ttys are not seekable
+    sqe->buf_index = (uint16_t)up->id;
+    sqe->user_data = up->id;
+    up->in_flight = true;
+}
+
+// --- Setup ---
+static inline void comchip_uring_unmap(ComchipUring* u) {
+    if (u->sqes) {
+        munmap(u->sqes, u->sqes_sz);
+    }
+    if (u->cq_ring && u->cq_ring != u->sq_ring) {
+        munmap(u->cq_ring, u->cq_ring_sz);
+    }
+    if (u->sq_ring) {
+        munmap(u->sq_ring, u->sq_ring_sz);
+    }
+}
+
+// Returns 0, or -1 with errno set. ports_cap is at most 65536 (buf_index is 16 bits).
+static inline int comchip_uring_init(ComchipUring* u, uint32_t ports_cap, comchip_batch_cb on_batch,
+                                     comchip_closed_cb on_closed, void* ctx) {
+    memset(u, 0, sizeof(*u));
+    if (ports_cap == 0 || ports_cap > 65536) {
+        errno = EINVAL;
+        return -1;
+    }
+
+    // Room for one read and one cancel per port in flight
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    // (the kernel rejects a completion queue smaller than the submission queue)
+    uint32_t entries = ports_cap < 8 ? 8 : ports_cap;
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = 2 * entries;
+    u->ring_fd = comchip_uring_setup(entries, &p);
+    if (u->ring_fd < 0) {
+        return -1;
+    }
+    if (!(p.features & IORING_FEAT_EXT_ARG)) {
+        close(u->ring_fd);
+        errno = ENOSYS; // Kernel older than 5.11: no timed wait in io_uring_enter()
+        return -1;
+    }
+
+    u->sq_ring_sz = p.sq_off.array + p.sq_entries * sizeof(uint32_t);
+    u->cq_ring_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        u->sq_ring_sz = u->sq_ring_sz > u->cq_ring_sz ? u->sq_ring_sz : u->cq_ring_sz;
+    }
+    u->sq_ring = mmap(NULL, u->sq_ring_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      u->ring_fd, IORING_OFF_SQ_RING);
+    if (u->sq_ring == MAP_FAILED) {
+        u->sq_ring = NULL;
+        goto fail;
+    }
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        u->cq_ring = u->sq_ring;
+    } else {
+        u->cq_ring = mmap(NULL, u->cq_ring_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          u->ring_fd, IORING_OFF_CQ_RING);
+        if (u->cq_ring == MAP_FAILED) {
+            u->cq_ring = NULL;
+            goto fail;
+        }
+    }
+    u->sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+    u->sqes = (struct io_uring_sqe*)mmap(NULL, u->sqes_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                                         u->ring_fd, IORING_OFF_SQES);
+    if (u->sqes == MAP_FAILED) {
+        u->sqes = NULL;
+        goto fail;
+    }
+
+    u->sq_head = (uint32_t*)((char*)u->sq_ring + p.sq_off.head);
+    u->sq_tail = (uint32_t*)((char*)u->sq_ring + p.sq_off.tail);
+    u->sq_array = (uint32_t*)((char*)u->sq_ring + p.sq_off.array);
+    u->sq_mask = *(uint32_t*)((char*)u->sq_ring + p.sq_off.ring_mask);
+    u->sq_entries = p.sq_entries;
+    u->sq_local_tail = *u->sq_tail;
+    u->cq_head = (uint32_t*)((char*)u->cq_ring + p.cq_off.head);
+    u->cq_tail = (uint32_t*)((char*)u->cq_ring + p.cq_off.tail);
+    u->cq_mask = *(uint32_t*)((char*)u->cq_ring + p.cq_off.ring_mask);
+    u->cqes = (struct io_uring_cqe*)((char*)u->cq_ring + p.cq_off.cqes);
+
+    // Every port's receive buffer is registered up front; the port id is its buffer index
+    u->ports = (ComchipUringPort*)calloc(ports_cap, sizeof(*u->ports));
+    u->free_ids = (uint32_t*)malloc(ports_cap * sizeof(uint32_t));
+    struct iovec* iov = (struct iovec*)malloc(ports_cap * sizeof(struct iovec));
+    if (!u->ports || !u->free_ids || !iov) {
+        free(iov);
+        errno = ENOMEM;
+        goto fail;
+    }
+    for (uint32_t i = 0; i < ports_cap; i++) {
+        iov[i].iov_base = u->ports[i].port.rx;
+        iov[i].iov_len = sizeof(u->ports[i].port.rx);
+        u->free_ids[i] = ports_cap - 1 - i; // Hand out low ids first
+    }
+    int rc = comchip_uring_register(u->ring_fd, IORING_REGISTER_BUFFERS, iov, ports_cap);
+    free(iov);
+    if (rc < 0) {
+        goto fail; // e.g. ENOMEM from RLIMIT_MEMLOCK
+    }
+
+    u->ports_cap = ports_cap;
+    u->free_count = ports_cap;
+    comchip_event_batch_init(&u->out, on_batch, on_closed, ctx);
+    return 0;
+
+fail:;
+    int saved = errno;
+    comchip_uring_unmap(u);
+    close(u->ring_fd);
+    free(u->ports);
+    free(u->free_ids);
+    memset(u, 0, sizeof(*u));
+    u->ring_fd = -1;
+    errno = saved;
+    return -1;
+}
+
+// Closing the ring cancels every posted read; port fds are closed after it
+static inline void comchip_uring_close(ComchipUring* u) {
+    close(u->ring_fd);
+    comchip_uring_unmap(u);
+    for (uint32_t i = 0; i < u->ports_cap; i++) {
+        if (u->ports[i].active || u->ports[i].in_flight) {
+            close(u->ports[i].port.fd);
+            close(u->ports[i].owner_fd);
+        }
+    }
+    free(u->ports);
+    free(u->free_ids);
+    memset(u, 0, sizeof(*u));
+    u->ring_fd = -1;
+}
+
+static inline void comchip_uring_on_frame(void* ctx, const BatteryStatusData* data) {
+    ComchipUringPort* up = (ComchipUringPort*)ctx;
+    comchip_event_batch_push(&up->uring->out, up->id, data);
+}
+
+// A second, blocking descriptor for the file behind fd. io_uring fails reads
+// on O_NONBLOCK files with EAGAIN instead of waiting for data, but the
+// caller's fd must stay non-blocking: the engine and the bus arbiter write
+// requests to it from the event loop. Reopening through /proc gives a new
+// open file description with its own flags (works for ttys, ptys and pipes).
+// Returns the fd, or -1 with errno set.
+static inline int comchip_uring_reopen(int fd) {
+    char path[32];
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+    return open(path, O_RDONLY | O_NOCTTY | O_CLOEXEC);
+}
+
+// Take ownership of a configured fd (see comchip_serial_open()) and post its
+// first read. Reads go through a blocking descriptor of its own (see
+// comchip_uring_reopen()); fd itself is not changed and stays usable for
+// non-blocking writes until the port is removed.
+// layout_len is the port's status frame length, or 0 to detect it.
+// Returns the port id, or -1 with errno set.
+static inline int32_t comchip_uring_add(ComchipUring* u, int fd, uint8_t layout_len) {
+    if (u->free_count == 0) {
+        errno = ENOSPC;
+        return -1;
+    }
+    int read_fd = comchip_uring_reopen(fd);
+    if (read_fd < 0) {
+        return -1;
+    }
+
+    uint32_t id = u->free_ids[--u->free_count];
+    ComchipUringPort* up = &u->ports[id];
+    comchip_port_init(&up->port, read_fd, comchip_uring_on_frame, up);
+    up->owner_fd = fd;
+    if (layout_len) {
+        comchip_stream_set_layout(&up->port.stream, layout_len);
+    }
+    up->uring = u;
+    up->id = id;
+    up->active = true;
+    comchip_uring_post_read(u, up); // Submitted by the next comchip_uring_run_once()
+    return (int32_t)id;
+}
+
+// Release a port whose read is no longer posted
+static inline void comchip_uring_release(ComchipUring* u, ComchipUringPort* up) {
+    close(up->port.fd);
+    close(up->owner_fd);
+    up->active = false;
+    u->free_ids[u->free_count++] = up->id;
+}
+
+// Unregister and close a port. Its posted read is cancelled first; the fd
+// and buffer are released once that read completes.
+static inline void comchip_uring_remove(ComchipUring* u, uint32_t id) {
+    ComchipUringPort* up = &u->ports[id];
+    if (!up->active) {
+        return;
+    }
+    if (!up->in_flight) {
+        comchip_uring_release(u, up);
+        return;
+    }
+    up->active = false;
+    struct io_uring_sqe* sqe = comchip_uring_get_sqe(u);
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->addr = id;
+    sqe->user_data = COMCHIP_URING_CANCEL_TAG;
+}
+
+static inline void comchip_uring_complete(ComchipUring* u, uint64_t user_data, int32_t res) {
+    if (user_data == COMCHIP_URING_CANCEL_TAG) {
+        return;
+    }
+    ComchipUringPort* up = &u->ports[user_data];
+    up->in_flight = false;
+
+    if (!up->active) {
+        comchip_uring_release(u, up); // Removed while the read was posted
+        return;
+    }
+    if (res > 0) {
+        up->port.reads++;
+        up->port.bytes_read += (uint64_t)res;
+        comchip_stream_feed(&up->port.stream, up->port.rx, (size_t)res);
+        comchip_uring_post_read(u, up);
+    } else if (res == -EAGAIN || res == -EINTR) {
+        comchip_uring_post_read(u, up);
+    } else {
+        comchip_uring_release(u, up); // EOF, or EIO once the other end of a pty is gone
+        comchip_event_batch_closed(&u->out, up->id);
+    }
+}
+
+// --- Run ---
+// Submit re-armed reads, wait up to timeout_ms (-1 = forever) for
+// completions, decode them and deliver the batch.
+// Returns the number of frames delivered, or -1 with errno set.
+static inline int comchip_uring_run_once(ComchipUring* u, int timeout_ms) {
+    uint64_t frames_before = u->out.frames;
+
+    if (comchip_uring_submit(u, timeout_ms != 0 ? 1 : 0, timeout_ms) < 0 && errno != ETIME) {
+        return -1;
+    }
+
+    uint32_t head = *u->cq_head;
+    uint32_t tail = __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE);
+    while (head != tail) {
+        const struct io_uring_cqe* cqe = &u->cqes[head & u->cq_mask];
+        uint64_t user_data = cqe->user_data;
+        int32_t res = cqe->res;
+        head++;
+        u->completions++;
+        comchip_uring_complete(u, user_data, res);
+        if (head == tail) {
+            __atomic_store_n(u->cq_head, head, __ATOMIC_RELEASE);
+            tail = __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE);
+        }
+    }
+    __atomic_store_n(u->cq_head, head, __ATOMIC_RELEASE);
+
+    comchip_event_batch_flush(&u->out);
+    return (int)(u->out.frames - frames_before);
+}
+
+#endif // COMCHIP_URING_H
@@ -0,0 +1,245 @@
+// --- COMChip Hierarchical Timing Wheel ---
+// Timers for request deadlines, retry backoff and link watchdogs, with O(1)
+// arm, cancel and expiry no matter how many are pending.
+//
+// Time is counted in ticks (e.g. 1 ms). Level 0 has one slot per tick for the
+// next 256 ticks, level 1 one slot per 256 ticks for the next 65536, and so
+// on for four levels (2^32 ticks, 49 days at 1 ms). A timer goes into the
+// level its distance falls in; when level 0 wraps around, the next level-1
+// slot is emptied and its timers are re-inserted, now landing in level 0
+// (cascading). Each slot is an intrusive doubly linked list, so arming and
+// cancelling never allocate or search. A timer further out than the wheel's
+// range fires at the end of the range.
+//
+// Event loop integration: comchip_wheel_timeout_ms() gives the wait for
+// epoll_wait()/run_once(), and comchip_wheel_advance() runs what expired.
+// Idle stretches are skipped slot-wise with an occupancy bitmap rather than
+// tick by tick.
+
+#ifndef COMCHIP_WHEEL_H
+#define COMCHIP_WHEEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "comchip_time.h"
+
+#define COMCHIP_WHEEL_BITS   8
+#define COMCHIP_WHEEL_SLOTS  (1u << COMCHIP_WHEEL_BITS)
+#define COMCHIP_WHEEL_MASK   (COMCHIP_WHEEL_SLOTS - 1)
+#define COMCHIP_WHEEL_LEVELS 4
+#define COMCHIP_WHEEL_RANGE  ((uint64_t)1 << (COMCHIP_WHEEL_BITS * COMCHIP_WHEEL_LEVELS)) // Ticks
+
+typedef struct ComchipTimer ComchipTimer;
+typedef void (*comchip_timer_cb)(void* ctx, ComchipTimer* t);
+
+struct ComchipTimer {
+    ComchipTimer*    next; // NULL when not armed
+    ComchipTimer*    prev;
+    uint64_t         expires; // Tick
+    uint8_t          level;
+    uint8_t          slot;
+    comchip_timer_cb fn;
+    void*            ctx;
+};
+
+typedef struct {
+    ComchipTimer slots[COMCHIP_WHEEL_LEVELS][COMCHIP_WHEEL_SLOTS]; // List heads
+    uint64_t     occupied[COMCHIP_WHEEL_SLOTS / 64];               // Level-0 slots that hold timers
+    uint64_t     now;      // Last tick processed
+    uint64_t     tick_ns;
+    uint64_t     start_ns; // Time of tick 0
+    uint32_t     armed;    // Timers pending
+
+    uint64_t     fired;    // Counters for diagnostics
+    uint64_t     cascaded;
+} ComchipWheel;
+
+static inline void comchip_wheel_init(ComchipWheel* w, uint64_t tick_ns, uint64_t now_ns) {
+    memset(w, 0, sizeof(*w));
+    for (unsigned l = 0; l < COMCHIP_WHEEL_LEVELS; l++) {
+        for (unsigned s = 0; s < COMCHIP_WHEEL_SLOTS; s++) {
+            w->slots[l][s].next = &w->slots[l][s];
+            w->slots[l][s].prev = &w->slots[l][s];
+        }
+    }
+    w->tick_ns = tick_ns;
+    w->start_ns = now_ns;
+}
+
+static inline void comchip_timer_init(ComchipTimer* t, comchip_timer_cb fn, void* ctx) {
+    memset(t, 0, sizeof(*t));
+    t->fn = fn;
+    t->ctx = ctx;
+}
+
+static inline bool comchip_timer_armed(const ComchipTimer* t) {
+    return t->next != NULL;
+}
+
+// --- Internals ---
+static inline void comchip_wheel_insert(ComchipWheel* w, ComchipTimer* t) {
+    uint64_t delta = t->expires - w->now;
+    unsigned level = 0;
+    while (level < COMCHIP_WHEEL_LEVELS - 1 && delta >= ((uint64_t)1 << (COMCHIP_WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+    unsigned slot = (unsigned)(t->expires >> (COMCHIP_WHEEL_BITS * level)) & COMCHIP_WHEEL_MASK;
+
+    ComchipTimer* head = &w->slots[level][slot];
+    t->next = head;
+    t->prev = head->prev;
+    head->prev->next = t;
+    head->prev = t;
+    t->level = (uint8_t)level;
+    t->slot = (uint8_t)slot;
+    if (level == 0) {
+        w->occupied[slot / 64] |= (uint64_t)1 << (slot % 64);
+    }
+}
+
+static inline void comchip_wheel_unlink(ComchipWheel* w, ComchipTimer* t) {
+    t->prev->next = t->next;
+    t->next->prev = t->prev;
+    t->next = NULL;
+    t->prev = NULL;
+    ComchipTimer* head = &w->slots[t->level][t->slot];
+    if (t->level == 0 && head->next == head) {
+        w->occupied[t->slot / 64] &= ~((uint64_t)1 << (t->slot % 64));
+    }
+}
+
+// Detach a slot's whole list; returns its first timer (NULL-terminated chain)
+static inline ComchipTimer* comchip_wheel_take(ComchipWheel* w, unsigned level, unsigned slot) {
+    ComchipTimer* head = &w->slots[level][slot];
+    if (head->next == head) {
+        return NULL;
+    }
+    ComchipTimer* first = head->next;
+    head->prev->next = NULL;
+    head->next = head;
+    head->prev = head;
+    if (level == 0) {
+        w->occupied[slot / 64] &= ~((uint64_t)1 << (slot % 64));
+    }
+    return first;
+}
+
+// First occupied level-0 slot in (from, COMCHIP_WHEEL_SLOTS), or COMCHIP_WHEEL_SLOTS
+static inline unsigned comchip_wheel_next_slot(const ComchipWheel* w, unsigned from) {
+    for (unsigned s = from + 1; s < COMCHIP_WHEEL_SLOTS;) {
+        uint64_t bits = w->occupied[s / 64] >> (s % 64);
+        if (bits) {
+            return s + (unsigned)__builtin_ctzll(bits);
+        }
+        s = (s / 64 + 1) * 64;
+    }
+    return COMCHIP_WHEEL_SLOTS;
+}
+
+// --- Arm / Cancel ---
+// (Re)arm a timer to fire at due_ns. A time already passed fires on the next advance.
+static inline void comchip_timer_arm(ComchipWheel* w, ComchipTimer* t, uint64_t due_ns) {
+    uint64_t tick = due_ns <= w->start_ns ? 0 : (due_ns - w->start_ns + w->tick_ns - 1) / w->tick_ns;
+    if (tick <= w->now) {
+        tick = w->now + 1;
+    } else if (tick - w->now >= COMCHIP_WHEEL_RANGE) {
+        tick = w->now + COMCHIP_WHEEL_RANGE - 1;
+    }
+
+    if (comchip_timer_armed(t)) {
+        if (t->expires == tick) {
+            return; // Re-armed within the same tick: nothing to move
+        }
+        comchip_wheel_unlink(w, t);
+    } else {
+        w->armed++;
+    }
+    t->expires = tick;
+    comchip_wheel_insert(w, t);
+}
+
+static inline void comchip_timer_cancel(ComchipWheel* w, ComchipTimer* t) {
+    if (comchip_timer_armed(t)) {
+        comchip_wheel_unlink(w, t);
+        w->armed--;
+    }
+}
+
+// --- Expiry ---
+// Run every timer due at or before now_ns. Callbacks may arm and cancel
+// timers, including the one that fired. Returns the number fired.
+static inline uint32_t comchip_wheel_advance(ComchipWheel* w, uint64_t now_ns) {
+    uint64_t target = now_ns <= w->start_ns ? 0 : (now_ns - w->start_ns) / w->tick_ns;
+    uint32_t fired = 0;
+
+    while (w->now < target) {
+        // Next tick with work: an occupied level-0 slot, or the wrap where the next level cascades
+        unsigned slot = comchip_wheel_next_slot(w, (unsigned)(w->now & COMCHIP_WHEEL_MASK));
+        uint64_t next = (w->now & ~(uint64_t)COMCHIP_WHEEL_MASK) + slot;
+        if (w->armed == 0 || next > target) {
+            w->now = target;
+            break;
+        }
+        w->now = next;
+
+        if ((w->now & COMCHIP_WHEEL_MASK) == 0) {
+            for (unsigned l = 1; l < COMCHIP_WHEEL_LEVELS; l++) {
+                unsigned idx = (unsigned)(w->now >> (COMCHIP_WHEEL_BITS * l)) & COMCHIP_WHEEL_MASK;
+                for (ComchipTimer* t = comchip_wheel_take(w, l, idx); t;) {
+                    ComchipTimer* next_t = t->next;
+                    comchip_wheel_insert(w, t);
+                    w->cascaded++;
+                    t = next_t;
+                }
+                if (idx != 0) {
+                    break;
+                }
+            }
+        }
+
+        // Move the due slot onto a local list first: a callback may cancel
+        // another timer from the same slot, which must still be linked
+        ComchipTimer due;
+        ComchipTimer* head = &w->slots[0][w->now & COMCHIP_WHEEL_MASK];
+        if (head->next == head) {
+            continue;
+        }
+        due.next = head->next;
+        due.prev = head->prev;
+        due.next->prev = &due;
+        due.prev->next = &due;
+        head->next = head;
+        head->prev = head;
+        w->occupied[(w->now & COMCHIP_WHEEL_MASK) / 64] &= ~((uint64_t)1 << (w->now % 64));
+
+        while (due.next != &due) {
+            ComchipTimer* t = due.next;
+            t->prev->next = t->next;
+            t->next->prev = t->prev;
+            t->next = NULL;
+            t->prev = NULL;
+            w->armed--;
+            fired++;
+            t->fn(t->ctx, t);
+        }
+    }
+    w->fired += fired;
+    return fired;
+}
+
+// Milliseconds until comchip_wheel_advance() has something to do, for the
+// event loop's wait (-1 when no timer is armed). Timers in the upper levels
+// only bound the wait by the next cascade, which wakes the loop at most once
+// per 256 ticks.
+static inline int comchip_wheel_timeout_ms(const ComchipWheel* w, uint64_t now_ns) {
+    if (w->armed == 0) {
+        return -1;
+    }
+    unsigned slot = comchip_wheel_next_slot(w, (unsigned)(w->now & COMCHIP_WHEEL_MASK));
+    uint64_t next = (w->now & ~(uint64_t)COMCHIP_WHEEL_MASK) + slot;
+    return comchip_timeout_ms(w->start_ns + next * w->tick_ns, now_ns);
+}
+
+#endif // COMCHIP_WHEEL_H